@@ -81,6 +81,7 @@ namespace
       _t( VERSION_CMP_e )	| "versioncmp"		| "vcmp";
       _t( LICENSES_e )		| "licenses";
       _t( PS_e )		| "ps";
+      _t( COMPLETE_e )		| "complete";
       _t( DOWNLOAD_e )		| "download";
       _t( SOURCE_DOWNLOAD_e )	| "source-download";
 
@@ -161,6 +162,7 @@ DEF_ZYPPER_COMMAND( TARGET_OS );
 DEF_ZYPPER_COMMAND( VERSION_CMP );
 DEF_ZYPPER_COMMAND( LICENSES );
 DEF_ZYPPER_COMMAND( PS );
+DEF_ZYPPER_COMMAND( COMPLETE );
 DEF_ZYPPER_COMMAND( DOWNLOAD );
 DEF_ZYPPER_COMMAND( SOURCE_DOWNLOAD );
 
@@ -69,6 +69,7 @@ struct ZypperCommand
   static const ZypperCommand VERSION_CMP;
   static const ZypperCommand LICENSES;
   static const ZypperCommand PS;
+  static const ZypperCommand COMPLETE;
   static const ZypperCommand DOWNLOAD;
   static const ZypperCommand SOURCE_DOWNLOAD;
 
@@ -146,6 +147,7 @@ struct ZypperCommand
     VERSION_CMP_e,
     LICENSES_e,
     PS_e,
+    COMPLETE_e,
     DOWNLOAD_e,
     SOURCE_DOWNLOAD_e,
 
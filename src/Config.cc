@@ -10,6 +10,7 @@ extern "C"
   #include <libintl.h>
 }
 #include <iostream>
+#include <algorithm>
 
 #include <zypp/base/Logger.h>
 #include <zypp/base/Measure.h>
@@ -17,7 +18,7 @@ extern "C"
 #include <zypp/base/Exception.h>
 #include <zypp/ZConfig.h>
 
-#include "utils/Augeas.h"
+#include "utils/IniConfig.h"
 #include "Config.h"
 
 // redefine _ gettext macro defined by ZYpp
@@ -101,6 +102,8 @@ namespace
     SOLVER_FORCE_RESOLUTION_COMMANDS,
 
     COMMIT_PS_CHECK_ACCESS_DELETED,
+    COMMIT_DOWNLOAD_CONNECTIONS,
+    COMMIT_DOWNLOAD_CONNECTIONS_PER_HOST,
 
     COLOR_USE_COLORS,
     COLOR_RESULT,
@@ -132,6 +135,8 @@ namespace
       { "solver/forceResolutionCommands",	ConfigOption::SOLVER_FORCE_RESOLUTION_COMMANDS	},
 
       { "commit/psCheckAccessDeleted",		ConfigOption::COMMIT_PS_CHECK_ACCESS_DELETED	},
+      { "commit/downloadConnections",		ConfigOption::COMMIT_DOWNLOAD_CONNECTIONS	},
+      { "commit/downloadConnectionsPerHost",	ConfigOption::COMMIT_DOWNLOAD_CONNECTIONS_PER_HOST },
 
       { "color/useColors",			ConfigOption::COLOR_USE_COLORS			},
       //"color/background"			LEGACY
@@ -174,6 +179,8 @@ Config::Config()
   : repo_list_columns("anr")
   , solver_installRecommends(!ZConfig::instance().solver_onlyRequires())
   , psCheckAccessDeleted(true)
+  , download_connections(4)
+  , download_connectionsPerHost(2)
   , do_colors		(false)
   , color_useColors	("autodetect")
   , color_result	(namedColor("default"))
@@ -201,32 +208,32 @@ void Config::read( const std::string & file )
     debug::Measure m("ReadConfig");
     std::string s;
 
-    Augeas augeas(file);
+    IniConfig conf(file);
 
     m.elapsed();
 
     // ---------------[ main ]--------------------------------------------------
 
-    s = augeas.getOption(asString( ConfigOption::MAIN_SHOW_ALIAS ));
+    s = conf.getOption(asString( ConfigOption::MAIN_SHOW_ALIAS ));
     if (!s.empty())
     {
       // using Repository::asUserString() will follow repoLabelIsAlias!
       ZConfig::instance().repoLabelIsAlias( str::strToBool(s, false) );
     }
 
-    s = augeas.getOption(asString( ConfigOption::MAIN_REPO_LIST_COLUMNS ));
+    s = conf.getOption(asString( ConfigOption::MAIN_REPO_LIST_COLUMNS ));
     if (!s.empty()) // TODO add some validation
       repo_list_columns = s;
 
     // ---------------[ solver ]------------------------------------------------
 
-    s = augeas.getOption(asString( ConfigOption::SOLVER_INSTALL_RECOMMENDS ));
+    s = conf.getOption(asString( ConfigOption::SOLVER_INSTALL_RECOMMENDS ));
     if (s.empty())
       solver_installRecommends = !ZConfig::instance().solver_onlyRequires();
     else
       solver_installRecommends = str::strToBool(s, true);
 
-    s = augeas.getOption(asString( ConfigOption::SOLVER_FORCE_RESOLUTION_COMMANDS ));
+    s = conf.getOption(asString( ConfigOption::SOLVER_FORCE_RESOLUTION_COMMANDS ));
     if (s.empty())
       solver_forceResolutionCommands.insert(ZypperCommand::REMOVE);
     else
@@ -239,13 +246,21 @@ void Config::read( const std::string & file )
 
     // ---------------[ commit ]------------------------------------------------
 
-    s = augeas.getOption(asString( ConfigOption::COMMIT_PS_CHECK_ACCESS_DELETED ));
+    s = conf.getOption(asString( ConfigOption::COMMIT_PS_CHECK_ACCESS_DELETED ));
     if ( ! s.empty() )
       psCheckAccessDeleted = str::strToBool( s, psCheckAccessDeleted );
 
+    s = conf.getOption(asString( ConfigOption::COMMIT_DOWNLOAD_CONNECTIONS ));
+    if ( ! s.empty() )
+      download_connections = std::max( 1U, str::strtonum<unsigned>( s ) );
+
+    s = conf.getOption(asString( ConfigOption::COMMIT_DOWNLOAD_CONNECTIONS_PER_HOST ));
+    if ( ! s.empty() )
+      download_connectionsPerHost = std::max( 1U, str::strtonum<unsigned>( s ) );
+
     // ---------------[ colors ]------------------------------------------------
 
-    s = augeas.getOption( asString( ConfigOption::COLOR_USE_COLORS ) );
+    s = conf.getOption( asString( ConfigOption::COLOR_USE_COLORS ) );
     if (!s.empty())
       color_useColors = s;
 
@@ -267,7 +282,7 @@ void Config::read( const std::string & file )
       { color_pkglistHighlightAttribute, ConfigOption::COLOR_PKGLISTHIGHLIGHT_ATTRIBUTE },
     } )
     {
-      c = namedColor( augeas.getOption( asString( el.second ) ) );
+      c = namedColor( conf.getOption( asString( el.second ) ) );
       if ( c )
 	el.first = c;
       // Fix color attributes: Default is mapped to Unchanged to allow
@@ -282,7 +297,7 @@ void Config::read( const std::string & file )
       }
     }
 
-    s = augeas.getOption( asString( ConfigOption::COLOR_PKGLISTHIGHLIGHT ) );
+    s = conf.getOption( asString( ConfigOption::COLOR_PKGLISTHIGHLIGHT ) );
     if (!s.empty())
     {
       if ( s == "all" )
@@ -295,13 +310,13 @@ void Config::read( const std::string & file )
 	WAR << "zypper.conf: color/pkglistHighlight: unknown value '" << s << "'" << endl;
     }
 
-    s = augeas.getOption("color/background");	// legacy
+    s = conf.getOption("color/background");	// legacy
     if ( !s.empty() )
       WAR << "zypper.conf: ignore legacy option 'color/background'" << endl;
 
     // ---------------[ obs ]---------------------------------------------------
 
-    s = augeas.getOption(asString( ConfigOption::OBS_BASE_URL ));
+    s = conf.getOption(asString( ConfigOption::OBS_BASE_URL ));
     if (!s.empty())
     {
       try { obs_baseUrl = Url(s); }
@@ -311,7 +326,7 @@ void Config::read( const std::string & file )
       }
     }
 
-    s = augeas.getOption(asString( ConfigOption::OBS_PLATFORM ));
+    s = conf.getOption(asString( ConfigOption::OBS_PLATFORM ));
     if (!s.empty())
       obs_platform = s;
 
@@ -320,6 +335,6 @@ void Config::read( const std::string & file )
   catch (Exception & e)
   {
     std::cerr << e.asUserHistory() << endl;
-    std::cerr << "*** Augeas exception. No config read, sticking with defaults." << endl;
+    std::cerr << "*** Config exception. No config read, sticking with defaults." << endl;
   }
 }
@@ -35,6 +35,9 @@ struct Config
 
   bool psCheckAccessDeleted;	///< do post commit 'zypper ps' check?
 
+  unsigned download_connections;	///< max. number of parallel package downloads
+  unsigned download_connectionsPerHost;	///< max. number of parallel package downloads per server
+
   /**
    * Whether to colorize the output. This is evaluated according to
    * color_useColors and has_colors()
@@ -0,0 +1,316 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <map>
+
+#include <zypp/base/Logger.h>
+#include <zypp/base/String.h>
+#include <zypp/Package.h>
+#include <zypp/PathInfo.h>
+#include <zypp/TmpPath.h>
+#include <zypp/media/MediaManager.h>
+#include <zypp/target/CommitPackageCache.h>
+
+#include "Zypper.h"
+#include "ParallelDownload.h"
+
+ParallelDownload::ParallelDownload( Zypper & zypper_r, const FetchFnc & fetch_r )
+: _zypper( zypper_r )
+, _fetch( fetch_r )
+{}
+
+bool ParallelDownload::add( const PoolItem & pi_r )
+{
+  Package::constPtr pkg( pi_r->asKind<Package>() );
+  if ( pkg && pkg->isCached() )
+    return false;
+
+  // Local media (dir, iso, cd, ...) gain nothing from parallel access.
+  const Url & url( pi_r->repoInfo().url() );
+  if ( ! url.isValid() || ! url.schemeIsDownloading() )
+    return false;
+
+  _jobs.push_back( Job{ pi_r, url.getHost() } );
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+void ParallelDownload::workerMain( int jobFd_r, int resultFd_r )
+{
+  ::signal( SIGINT, SIG_DFL );
+  ::signal( SIGTERM, SIG_DFL );
+  ::signal( SIGPIPE, SIG_DFL );
+
+  // Never prompt or print; the main process does the reporting and
+  // retrieves failed packages again.
+  int devnull = ::open( "/dev/null", O_RDWR );
+  if ( devnull >= 0 )
+  {
+    ::dup2( devnull, 0 );
+    ::dup2( devnull, 1 );
+    ::dup2( devnull, 2 );
+    if ( devnull > 2 )
+      ::close( devnull );
+  }
+  _zypper.globalOptsNoConst().non_interactive = true;
+  _zypper.out().setVerbosity( Out::QUIET );
+
+  // Use a private attach prefix, so we can clean up our attach points
+  // without running the destructors of objects shared with the parent.
+  Pathname attachPrefix( filesystem::TmpPath::defaultLocation() / str::form( "zypper-download.%d", ::getpid() ) );
+  if ( filesystem::assert_dir( attachPrefix ) == 0 )
+    media::MediaManager::setAttachPrefix( attachPrefix );
+  else
+    attachPrefix = Pathname();
+
+  MIL << "Download worker started" << endl;
+  int ret = 0;
+  FILE * jobs = ::fdopen( jobFd_r, "r" );
+  try
+  {
+    FetchFnc fetch( _fetch );
+    if ( ! fetch )
+    {
+      shared_ptr<target::CommitPackageCache> packageCache( new target::CommitPackageCache( _zypper.globalOpts().root_dir ) );
+      fetch = [packageCache]( const PoolItem & pi_r ) {
+        ManagedFile localfile( packageCache->get( pi_r ) );
+        localfile.resetDispose();
+        return localfile.value();
+      };
+    }
+
+    char buf[64];
+    while ( jobs && ::fgets( buf, sizeof(buf), jobs ) )
+    {
+      unsigned idx = str::strtonum<unsigned>( buf );
+      std::string path;
+      if ( idx < _jobs.size() )
+      {
+        try
+        {
+          path = fetch( _jobs[idx]._pi ).asString();
+        }
+        catch ( const Exception & exp )
+        {
+          ZYPP_CAUGHT( exp );
+          WAR << "Failed to download " << _jobs[idx]._pi << endl;
+        }
+      }
+      std::string result( str::numstring( idx ) + "\t" + path + "\n" );
+      if ( ::write( resultFd_r, result.c_str(), result.size() ) != ssize_t(result.size()) )
+        break;
+    }
+  }
+  catch ( ... )
+  {
+    ret = 1;
+  }
+
+  if ( ! attachPrefix.empty() )
+    filesystem::recursive_rmdir( attachPrefix );
+  MIL << "Download worker done" << endl;
+  ::_exit( ret );
+}
+
+// ---------------------------------------------------------------------------
+
+unsigned ParallelDownload::run( const DoneFnc & done_r )
+{
+  const unsigned perHost = _zypper.config().download_connectionsPerHost;
+  unsigned connections = _zypper.config().download_connections;
+  if ( connections > _jobs.size() )
+    connections = _jobs.size();
+  if ( _jobs.size() < 2 || connections < 2 )
+  {
+    _jobs.clear();
+    return 0;
+  }
+
+  MIL << "Retrieving " << _jobs.size() << " packages using " << connections
+      << " connections (" << perHost << " per host)" << endl;
+
+  // a worker may die while we write to it
+  struct sigaction ignore, oldSigpipe;
+  ::memset( &ignore, 0, sizeof(ignore) );
+  ignore.sa_handler = SIG_IGN;
+  ::sigaction( SIGPIPE, &ignore, &oldSigpipe );
+
+  struct Worker
+  {
+    pid_t _pid;
+    int _jobFd;
+    FILE * _result;
+    int _job;
+  };
+  std::vector<Worker> workers;
+  std::vector<int> parentFds;	// to be closed in each worker
+
+  std::cout.flush();
+  std::cerr.flush();
+  for ( unsigned i = 0; i < connections; ++i )
+  {
+    int jobPipe[2];
+    int resultPipe[2];
+    if ( ::pipe( jobPipe ) != 0 )
+      break;
+    if ( ::pipe( resultPipe ) != 0 )
+    {
+      ::close( jobPipe[0] );
+      ::close( jobPipe[1] );
+      break;
+    }
+
+    pid_t pid = ::fork();
+    if ( pid < 0 )
+    {
+      WAR << "fork failed: " << str::strerror( errno ) << endl;
+      for ( int fd : { jobPipe[0], jobPipe[1], resultPipe[0], resultPipe[1] } )
+        ::close( fd );
+      break;
+    }
+    if ( pid == 0 )
+    {
+      for ( int fd : parentFds )
+        ::close( fd );
+      ::close( jobPipe[1] );
+      ::close( resultPipe[0] );
+      workerMain( jobPipe[0], resultPipe[1] );	// never returns
+    }
+
+    ::close( jobPipe[0] );
+    ::close( resultPipe[1] );
+    parentFds.push_back( jobPipe[1] );
+    parentFds.push_back( resultPipe[0] );
+    workers.push_back( Worker{ pid, jobPipe[1], ::fdopen( resultPipe[0], "r" ), -1 } );
+  }
+
+  unsigned fetched = 0;
+  if ( ! workers.empty() )
+  {
+    std::list<unsigned> pending;
+    for ( unsigned i = 0; i < _jobs.size(); ++i )
+      pending.push_back( i );
+    std::map<std::string,unsigned> hostLoad;
+
+    // pass the next job not exceeding the per host limit to an idle worker
+    auto assign = [&]( Worker & worker_r )
+    {
+      for ( auto it = pending.begin(); it != pending.end(); ++it )
+      {
+        unsigned & load( hostLoad[_jobs[*it]._host] );
+        if ( load >= perHost )
+          continue;
+        std::string line( str::numstring( *it ) + "\n" );
+        if ( ::write( worker_r._jobFd, line.c_str(), line.size() ) != ssize_t(line.size()) )
+        {
+          WAR << "Download worker " << worker_r._pid << " is gone" << endl;
+          ::fclose( worker_r._result );
+          worker_r._result = nullptr;
+          return;
+        }
+        ++load;
+        worker_r._job = *it;
+        pending.erase( it );
+        return;
+      }
+    };
+
+    Out::ProgressBar report( _zypper.out(), "parallel-download",
+                             str::Format(_("Retrieving %1% packages using %2% parallel connections")) % _jobs.size() % workers.size() );
+    report->range( _jobs.size() );
+    unsigned finished = 0;
+
+    while ( ! _zypper.exitRequested() )
+    {
+      std::vector<struct pollfd> fds;
+      std::vector<Worker *> busy;
+      for ( Worker & worker : workers )
+      {
+        if ( worker._result && worker._job < 0 )
+          assign( worker );
+        if ( worker._result && worker._job >= 0 )
+        {
+          fds.push_back( { ::fileno( worker._result ), POLLIN, 0 } );
+          busy.push_back( &worker );
+        }
+      }
+      if ( fds.empty() )
+        break;	// all done (or no worker left)
+
+      if ( ::poll( &fds[0], fds.size(), 500 ) <= 0 )
+        continue;
+
+      for ( unsigned i = 0; i < fds.size(); ++i )
+      {
+        if ( ! fds[i].revents )
+          continue;
+
+        Worker & worker( *busy[i] );
+        const Job & job( _jobs[worker._job] );
+        --hostLoad[job._host];
+        worker._job = -1;
+
+        Pathname localfile;
+        char buf[4096];
+        if ( ::fgets( buf, sizeof(buf), worker._result ) )
+        {
+          const char * tab = ::strchr( buf, '\t' );
+          if ( tab )
+            localfile = str::trim( std::string( tab + 1 ) );
+        }
+        else
+        {
+          WAR << "Download worker " << worker._pid << " is gone" << endl;
+          ::fclose( worker._result );
+          worker._result = nullptr;
+        }
+
+        report->set( ++finished );
+        if ( ! localfile.empty() && PathInfo( localfile ).isFile() )
+        {
+          ++fetched;
+          if ( done_r )
+            done_r( job._pi, localfile );
+        }
+        else
+          DBG << "Not retrieved: " << job._pi << endl;
+      }
+    }
+    if ( _zypper.exitRequested() )
+      report.error();
+    else
+      report.error( false );	// failed packages are retried later
+  }
+
+  // done: closing the job pipes lets the workers exit
+  for ( Worker & worker : workers )
+  {
+    ::close( worker._jobFd );
+    if ( _zypper.exitRequested() )
+      ::kill( worker._pid, SIGTERM );
+    if ( worker._result )
+      ::fclose( worker._result );
+    int status = 0;
+    ::waitpid( worker._pid, &status, 0 );
+  }
+  ::sigaction( SIGPIPE, &oldSigpipe, nullptr );
+
+  MIL << "Retrieved " << fetched << " of " << _jobs.size() << " packages in parallel" << endl;
+  _jobs.clear();
+  return fetched;
+}
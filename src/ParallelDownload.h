@@ -0,0 +1,91 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#ifndef ZYPPER_PARALLELDOWNLOAD_H
+#define ZYPPER_PARALLELDOWNLOAD_H
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include <zypp/PoolItem.h>
+#include <zypp/Pathname.h>
+
+class Zypper;
+
+///////////////////////////////////////////////////////////////////
+/// \class ParallelDownload
+/// \brief Retrieve packages into the package cache using parallel connections.
+///
+/// Packages from downloading (http/https/ftp) repositories are fetched by
+/// up to \c commit/downloadConnections worker processes, each using its
+/// own libzypp media handle. At most \c commit/downloadConnectionsPerHost
+/// workers talk to the same server at a time. The main process shows a
+/// single progress bar for the whole batch.
+///
+/// Workers never prompt. A package they fail to retrieve is simply left
+/// uncached, so the caller's usual (serial) code path retrieves it again
+/// with full error reporting and user interaction. Running this is thus
+/// always optional and never changes the outcome of an operation.
+///
+/// \code
+///   ParallelDownload prefetch( zypper );
+///   for ( const PoolItem & pi : items )
+///     prefetch.add( pi );
+///   prefetch.run();
+///   // process items as before; most of them are cached now
+/// \endcode
+///
+/// By default packages are retrieved into the package cache. A custom
+/// \ref FetchFnc (executed in the worker processes) may retrieve other
+/// items, e.g. source packages, to different locations.
+///////////////////////////////////////////////////////////////////
+class ParallelDownload
+{
+public:
+  /** Called in the main process for each package retrieved. */
+  typedef std::function<void( const zypp::PoolItem &, const zypp::Pathname & )> DoneFnc;
+
+  /** Retrieve an item in a worker process, returning the local file (throws on error). */
+  typedef std::function<zypp::Pathname( const zypp::PoolItem & )> FetchFnc;
+
+public:
+  ParallelDownload( Zypper & zypper_r, const FetchFnc & fetch_r = FetchFnc() );
+
+  /** Queue \a pi_r if it's from a downloading repo and not a cached package.
+   * \return whether the package was queued.
+   */
+  bool add( const zypp::PoolItem & pi_r );
+
+  /** Number of queued packages. */
+  unsigned size() const
+  { return _jobs.size(); }
+
+  /** Retrieve all queued packages and clear the queue.
+   * Nothing is done if less than two packages are queued or parallel
+   * downloads are disabled in zypper.conf.
+   * \return the number of packages retrieved.
+   */
+  unsigned run( const DoneFnc & done_r = DoneFnc() );
+
+private:
+  struct Job
+  {
+    zypp::PoolItem _pi;
+    std::string _host;
+  };
+
+  /** Worker process main loop; never returns. */
+  void workerMain( int jobFd_r, int resultFd_r );
+
+private:
+  Zypper & _zypper;
+  FetchFnc _fetch;
+  std::vector<Job> _jobs;
+};
+
+#endif // ZYPPER_PARALLELDOWNLOAD_H
@@ -0,0 +1,170 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#ifndef ZYPPER_PATCHISSUEINDEX_H
+#define ZYPPER_PATCHISSUEINDEX_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+#include <zypp/base/Easy.h>
+#include <zypp/base/Logger.h>
+#include <zypp/base/String.h>
+#include <zypp/ResPool.h>
+#include <zypp/Patch.h>
+
+using namespace zypp;
+
+///////////////////////////////////////////////////////////////////
+/// \class Issues
+/// \brief An issue (Type,Id) pair
+///
+/// Ids given on the commandline are matched as substring. Ids read
+/// from an \c --issue-file are \ref exact and matched as a whole.
+///////////////////////////////////////////////////////////////////
+struct Issue : std::pair<std::string, std::string>
+{
+  Issue( std::string issueType_r, std::string issueId_r, bool exact_r = false )
+  : std::pair<std::string, std::string>( std::move(issueType_r), std::move(issueId_r) )
+  , _exact( exact_r )
+  {}
+
+  std::string &       type()			{ return first; }
+  const std::string & type()		const	{ return first; }
+  bool                anyType()		const	{ return type().empty(); }
+  bool                specificType()	const	{ return !anyType(); }
+
+  std::string &       id()			{ return second; }
+  const std::string & id()		const	{ return second; }
+  bool                anyId()		const 	{ return id().empty(); }
+  bool                specificId()	const	{ return !anyId(); }
+
+  bool                exact()		const	{ return _exact; }
+
+private:
+  bool _exact;
+};
+
+///////////////////////////////////////////////////////////////////
+/// \class PatchIssueIndex
+/// \brief The issue references of all patches, collected in a single pass over the pool.
+///
+/// Resolving thousands of issues by running a \ref PoolQuery per issue is
+/// quadratic. Here all patch references are indexed once (case insensitive
+/// by id and by type), and each \ref Issue is looked up in the index.
+/// Patches rejected by the filter passed to the ctor are not indexed.
+///////////////////////////////////////////////////////////////////
+class PatchIssueIndex
+{
+public:
+  /** An indexed (Type,Id) reference of a patch. */
+  struct Ref
+  {
+    std::string _type;
+    std::string _id;
+    PoolItem    _pi;
+  };
+
+  typedef std::function<bool(const PoolItem &)> Filter;
+
+public:
+  PatchIssueIndex( const Filter & filter_r )
+  {
+    const ResPool & pool( ResPool::instance() );
+    for_( it, pool.byKindBegin(ResKind::patch), pool.byKindEnd(ResKind::patch) )
+    {
+      const PoolItem & pi( *it );
+      if ( filter_r && ! filter_r( pi ) )
+	continue;
+
+      Patch::constPtr patch( pi->asKind<Patch>() );
+      for_( ref, patch->referencesBegin(), patch->referencesEnd() )
+      {
+	unsigned idx = _refs.size();
+	_refs.push_back( Ref{ ref.type(), ref.id(), pi } );
+	_byId[str::toLower( _refs.back()._id )].push_back( idx );
+	_byType[str::toLower( _refs.back()._type )].push_back( idx );
+      }
+    }
+    DBG << "Indexed " << _refs.size() << " issue references in " << _byId.size() << " distinct ids." << endl;
+  }
+
+  /** Invoke \a fnc_r for each \ref Ref matching \a issue_r.
+   * Mimics the former \ref PoolQuery per issue: Ids are matched case
+   * insensitive as substring, or as a whole if \a exact_r. If \a matchTypes_r,
+   * an \c anyType issue's id also matches the type (bnc#941309, for
+   * \c list-patches). A specific type must match exactly.
+   */
+  template <class TFnc>
+  void forEachMatch( const Issue & issue_r, bool exact_r, bool matchTypes_r, TFnc fnc_r ) const
+  {
+    std::vector<unsigned> hits;
+
+    if ( issue_r.anyId() )
+    {
+      if ( issue_r.anyType() )
+      {
+	for ( unsigned idx = 0; idx < _refs.size(); ++idx )
+	  hits.push_back( idx );
+      }
+      else
+	collect( _byType, str::toLower( issue_r.type() ), true, hits );
+    }
+    else
+    {
+      const std::string & lid( str::toLower( issue_r.id() ) );
+      collect( _byId, lid, exact_r, hits );
+      if ( issue_r.anyType() && matchTypes_r )
+	collect( _byType, lid, exact_r, hits );
+    }
+    // Substring lookups collect in hash order: report in pool order, like
+    // the former PoolQuery. A reference matching by id and type is reported once.
+    std::sort( hits.begin(), hits.end() );
+    hits.erase( std::unique( hits.begin(), hits.end() ), hits.end() );
+
+    for ( unsigned idx : hits )
+    {
+      const Ref & ref( _refs[idx] );
+      if ( issue_r.specificType() && ref._type != issue_r.type() )
+	continue;	// assert correct type of specific IDs
+      fnc_r( ref );
+    }
+  }
+
+private:
+  typedef std::unordered_map<std::string, std::vector<unsigned>> Index;
+
+  /** Append the refs indexed under \a key_r (or any key containing it, unless \a exact_r). */
+  static void collect( const Index & index_r, const std::string & key_r, bool exact_r, std::vector<unsigned> & hits_r )
+  {
+    if ( exact_r )
+    {
+      Index::const_iterator it( index_r.find( key_r ) );
+      if ( it != index_r.end() )
+	hits_r.insert( hits_r.end(), it->second.begin(), it->second.end() );
+    }
+    else
+    {
+      // scans the distinct keys, not the patches
+      for ( const auto & entry : index_r )
+      {
+	if ( entry.first.find( key_r ) != std::string::npos )
+	  hits_r.insert( hits_r.end(), entry.second.begin(), entry.second.end() );
+      }
+    }
+  }
+
+private:
+  std::vector<Ref> _refs;
+  Index _byId;
+  Index _byType;
+};
+
+#endif // ZYPPER_PATCHISSUEINDEX_H
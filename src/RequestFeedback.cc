@@ -15,6 +15,7 @@
 #include "Zypper.h"
 #include "misc.h"
 #include "SolverRequester.h"
+#include "SimilarNames.h"
 
 /////////////////////////////////////////////////////////////////////////
 // SolverRequester::Feedback
@@ -240,8 +241,14 @@ void SolverRequester::Feedback::print( Out & out, const SolverRequester::Options
   {
     case NOT_FOUND_NAME:
     case NOT_FOUND_CAP:
+    {
       out.error( asUserString(opts) );
+      sat::Solvable::SplitIdent split( _reqpkg.parsed_cap.detail().name() );
+      std::string hint( SimilarNames::didYouMean( split.kind(), split.name().asString() ) );
+      if ( ! hint.empty() )
+	out.info( hint );
       break;
+    }
     case NOT_FOUND_NAME_TRYING_CAPS:
     case NOT_INSTALLED:
     case NO_INSTALLED_PROVIDER:
@@ -0,0 +1,893 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstring>
+#include <climits>
+#include <fstream>
+#include <initializer_list>
+#include <unordered_map>
+
+#include <zypp/base/Logger.h>
+#include <zypp/base/String.h>
+#include <zypp/PathInfo.h>
+#include <zypp/sat/LookupAttr.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/sat/SolvAttr.h>
+
+#include "Zypper.h"
+#include "SearchIndex.h"
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  const char textIndexName[]	= "zypper-text.index";
+  const char textIndexMagic[8]	= { 'Z', 'Y', 'P', 'P', 'T', 'X', 'T', '\0' };
+  const char pathIndexName[]	= "zypper-path.index";
+  const char pathIndexMagic[8]	= { 'Z', 'Y', 'P', 'P', 'P', 'T', 'H', '\0' };
+  const char nameIndexName[]	= "zypper-name.index";
+  const char nameIndexMagic[8]	= { 'Z', 'Y', 'P', 'P', 'N', 'A', 'M', '\0' };
+
+  /** Changes with the file layout, and with the byte order. */
+  const uint32_t indexVersion = 0x5a590001;
+
+  /** Common index file header, followed by the index specific sections. */
+  struct FileHeader
+  {
+    char     _magic[8];
+    uint32_t _version;
+    uint32_t _solvables;	//< solvables in the repo
+    uint64_t _solvSize;		//< size of the solv file the index was built from
+    int64_t  _solvMtime;	//< mtime of the solv file the index was built from
+    uint32_t _count[4];		//< index specific section sizes
+  };
+
+  /** Text index: sorted word table, followed by the words and the postings.
+   * Postings are the ascending solvable positions, delta and varint encoded.
+   */
+  struct WordEntry
+  {
+    uint32_t _strOff;
+    uint32_t _strLen;
+    uint32_t _postOff;
+    uint32_t _postLen;
+  };
+
+  /** Path index: the directories (including the trailing '/') and the base
+   * names, both sorted case folded; the files grouped by directory and sorted
+   * by name; the files (indices) sorted by name; and the strings.
+   */
+  struct DirEntry
+  {
+    uint32_t _strOff;
+    uint32_t _strLen;
+    uint32_t _first;	//< first file in this directory
+    uint32_t _count;
+  };
+
+  struct NameEntry
+  {
+    uint32_t _strOff;
+    uint32_t _strLen;
+  };
+
+  struct FileEntry
+  {
+    uint32_t _dir;
+    uint32_t _name;
+    uint32_t _pos;	//< solvable position
+  };
+
+  inline bool isWordChar( unsigned char ch )
+  { return ch >= 0x80 || ( ch >= '0' && ch <= '9' ) || ( ch >= 'a' && ch <= 'z' ) || ( ch >= 'A' && ch <= 'Z' ); }
+
+  inline char foldChar( unsigned char ch )
+  { return ( ch >= 'A' && ch <= 'Z' ) ? ch + ( 'a' - 'A' ) : ch; }
+
+  /** Invoke \a fnc_r for each case folded word in \a text_r.
+   * Non-ASCII bytes are treated as word characters and left as they are,
+   * just like libsolv's case insensitive substring match does.
+   */
+  template <class Fnc>
+  void forEachWord( const char * text_r, Fnc fnc_r )
+  {
+    std::string word;
+    for ( const char * p = text_r; ; ++p )
+    {
+      if ( *p && isWordChar( *p ) )
+	word += foldChar( *p );
+      else
+      {
+	if ( ! word.empty() )
+	{
+	  fnc_r( word );
+	  word.clear();
+	}
+	if ( ! *p )
+	  break;
+      }
+    }
+  }
+
+  /** Compare case folded (ASCII only). */
+  int foldcmp( const char * lhs_r, size_t llen_r, const char * rhs_r, size_t rlen_r )
+  {
+    for ( size_t i = 0; i < llen_r && i < rlen_r; ++i )
+    {
+      unsigned char l = foldChar( lhs_r[i] );
+      unsigned char r = foldChar( rhs_r[i] );
+      if ( l != r )
+	return l < r ? -1 : 1;
+    }
+    return llen_r < rlen_r ? -1 : ( llen_r > rlen_r ? 1 : 0 );
+  }
+
+  std::string folded( const std::string & str_r )
+  {
+    std::string ret( str_r );
+    for ( char & ch : ret )
+      ch = foldChar( ch );
+    return ret;
+  }
+
+  /** Whether \a str_r contains the (already folded) \a key_r, ignoring case. */
+  bool foldedContains( const char * str_r, size_t len_r, const std::string & key_r )
+  {
+    for ( size_t i = 0; i + key_r.size() <= len_r; ++i )
+    {
+      size_t j = 0;
+      while ( j < key_r.size() && foldChar( str_r[i+j] ) == key_r[j] )
+	++j;
+      if ( j == key_r.size() )
+	return true;
+    }
+    return false;
+  }
+
+  /** The range of \a table_r entries equal to (or, with \a prefix_r, starting
+   * with) \a key_r, ignoring case. The table must be sorted case folded.
+   */
+  template <class Entry>
+  std::pair<uint32_t,uint32_t> foldedRange( const Entry * table_r, uint32_t size_r, const char * strings_r,
+					     const std::string & key_r, bool prefix_r )
+  {
+    auto cmp = [&]( const Entry & ent_r ) {
+      size_t len = ent_r._strLen;
+      if ( prefix_r && len > key_r.size() )
+	len = key_r.size();
+      return foldcmp( strings_r + ent_r._strOff, len, key_r.data(), key_r.size() );
+    };
+    const Entry * begin = std::partition_point( table_r, table_r + size_r, [&]( const Entry & ent_r ) { return cmp( ent_r ) < 0; } );
+    const Entry * end = std::partition_point( begin, table_r + size_r, [&]( const Entry & ent_r ) { return cmp( ent_r ) == 0; } );
+    return std::make_pair( uint32_t(begin - table_r), uint32_t(end - table_r) );
+  }
+
+  inline void putVarint( std::string & buf_r, uint32_t val_r )
+  {
+    for ( ; val_r >= 0x80; val_r >>= 7 )
+      buf_r += char( ( val_r & 0x7f ) | 0x80 );
+    buf_r += char( val_r );
+  }
+
+  inline Pathname solvCacheDir( Zypper & zypper_r, const RepoInfo & repo_r )
+  { return zypper_r.globalOpts().rm_options.repoSolvCachePath / repo_r.escaped_alias(); }
+
+  /** The system repo's solv file is written by the target; by default to our solv cache, too. */
+  inline Pathname solvCacheDir( Zypper & zypper_r, const sat::Repository & repo_r )
+  {
+    if ( repo_r.isSystemRepo() )
+      return zypper_r.globalOpts().rm_options.repoSolvCachePath / repo_r.alias();
+    return solvCacheDir( zypper_r, repo_r.info() );
+  }
+
+  FileHeader makeHeader( const char * magic_r, const PathInfo & solv_r, unsigned solvables_r )
+  {
+    FileHeader header;
+    ::memset( &header, 0, sizeof(header) );
+    ::memcpy( header._magic, magic_r, sizeof(header._magic) );
+    header._version = indexVersion;
+    header._solvables = solvables_r;
+    header._solvSize = solv_r.size();
+    header._solvMtime = solv_r.mtime();
+    return header;
+  }
+
+  /** Whether \a header_r was built from the current \a solv_r. */
+  inline bool sameSolvFile( const FileHeader & header_r, const char * magic_r, const PathInfo & solv_r )
+  {
+    return ::memcmp( header_r._magic, magic_r, sizeof(header_r._magic) ) == 0
+	&& header_r._version == indexVersion
+	&& header_r._solvSize == uint64_t(solv_r.size())
+	&& header_r._solvMtime == int64_t(solv_r.mtime());
+  }
+
+  /** Quick check whether \a file_r is up to date, without loading anything. */
+  bool indexFileUpToDate( const Pathname & file_r, const char * magic_r, const PathInfo & solv_r )
+  {
+    std::ifstream in( file_r.c_str(), std::ios::binary );
+    FileHeader header;
+    return in.read( reinterpret_cast<char *>(&header), sizeof(header) ) && sameSolvFile( header, magic_r, solv_r );
+  }
+
+  /** Write the index via a temp file, so readers never see a partial one. */
+  bool writeIndexFile( const Pathname & file_r, const FileHeader & header_r, std::initializer_list<const std::string *> sections_r )
+  {
+    Pathname tmpfile( file_r.extend( ".new" ) );
+    {
+      std::ofstream out( tmpfile.c_str(), std::ios::binary );
+      if ( out )
+      {
+	out.write( reinterpret_cast<const char *>(&header_r), sizeof(header_r) );
+	for ( const std::string * section : sections_r )
+	  out.write( section->data(), section->size() );
+      }
+      if ( ! out.flush() )
+      {
+	WAR << "Can't write search index " << tmpfile << endl;
+	filesystem::unlink( tmpfile );
+	return false;
+      }
+    }
+    if ( filesystem::rename( tmpfile, file_r ) != 0 )
+    {
+      filesystem::unlink( tmpfile );
+      return false;
+    }
+    return true;
+  }
+
+  bool buildTextIndex( const Pathname & file_r, FileHeader header_r, const std::vector<sat::Solvable> & solvables_r )
+  {
+    std::unordered_map<std::string, std::vector<uint32_t>> postings;
+    for ( uint32_t pos = 0; pos < solvables_r.size(); ++pos )
+    {
+      auto addWord = [&postings,pos]( const std::string & word_r ) {
+	std::vector<uint32_t> & post( postings[word_r] );
+	if ( post.empty() || post.back() != pos )
+	  post.push_back( pos );
+      };
+      forEachWord( solvables_r[pos].lookupStrAttribute( sat::SolvAttr::summary ).c_str(), addWord );
+      forEachWord( solvables_r[pos].lookupStrAttribute( sat::SolvAttr::description ).c_str(), addWord );
+    }
+
+    std::vector<const std::string *> words;
+    words.reserve( postings.size() );
+    for ( const auto & ent : postings )
+      words.push_back( &ent.first );
+    std::sort( words.begin(), words.end(), []( const std::string * lhs, const std::string * rhs ) { return *lhs < *rhs; } );
+
+    std::string table;
+    std::string strings;
+    std::string posts;
+    table.reserve( words.size() * sizeof(WordEntry) );
+    for ( const std::string * word : words )
+    {
+      WordEntry ent;
+      ent._strOff = strings.size();
+      ent._strLen = word->size();
+      ent._postOff = posts.size();
+      strings += *word;
+      uint32_t last = 0;
+      for ( uint32_t pos : postings[*word] )
+      {
+	putVarint( posts, pos - last );
+	last = pos;
+      }
+      ent._postLen = posts.size() - ent._postOff;
+      table.append( reinterpret_cast<const char *>(&ent), sizeof(ent) );
+    }
+
+    header_r._count[0] = words.size();
+    header_r._count[1] = strings.size();
+    header_r._count[2] = posts.size();
+    if ( ! writeIndexFile( file_r, header_r, { &table, &strings, &posts } ) )
+      return false;
+
+    MIL << "Text index " << file_r << ": " << words.size() << " words, "
+        << ( sizeof(header_r) + table.size() + strings.size() + posts.size() ) << " bytes" << endl;
+    return true;
+  }
+
+  /** Name index: offsets of the sorted (byte order) distinct solvable idents,
+   * followed by the NUL terminated idents.
+   */
+  bool buildNameIndex( const Pathname & file_r, FileHeader header_r, const std::vector<sat::Solvable> & solvables_r )
+  {
+    std::vector<std::string> idents;
+    idents.reserve( solvables_r.size() );
+    for ( const sat::Solvable & solv : solvables_r )
+      idents.push_back( solv.ident().asString() );
+    std::sort( idents.begin(), idents.end() );
+    idents.erase( std::unique( idents.begin(), idents.end() ), idents.end() );
+
+    std::string table;
+    std::string strings;
+    table.reserve( idents.size() * sizeof(uint32_t) );
+    for ( const std::string & ident : idents )
+    {
+      uint32_t off = strings.size();
+      table.append( reinterpret_cast<const char *>(&off), sizeof(off) );
+      strings += ident;
+      strings += '\0';
+    }
+
+    header_r._count[0] = idents.size();
+    header_r._count[1] = strings.size();
+    if ( ! writeIndexFile( file_r, header_r, { &table, &strings } ) )
+      return false;
+
+    MIL << "Name index " << file_r << ": " << idents.size() << " names" << endl;
+    return true;
+  }
+
+  bool buildPathIndex( const Pathname & file_r, FileHeader header_r, const std::vector<sat::Solvable> & solvables_r )
+  {
+    typedef std::unordered_map<std::string,uint32_t> Ids;
+    Ids dirIds;
+    Ids nameIds;
+    std::vector<const std::string *> dirs;	// by id
+    std::vector<const std::string *> names;	// by id
+    auto intern = []( Ids & ids_r, std::vector<const std::string *> & strs_r, std::string && str_r ) {
+      auto res = ids_r.emplace( std::move(str_r), strs_r.size() );
+      if ( res.second )
+	strs_r.push_back( &res.first->first );
+      return res.first->second;
+    };
+
+    std::vector<FileEntry> files;
+    for ( uint32_t pos = 0; pos < solvables_r.size(); ++pos )
+    {
+      sat::LookupAttr filelist( sat::SolvAttr::filelist, solvables_r[pos] );
+      for_( it, filelist.begin(), filelist.end() )
+      {
+	std::string path( it.asString() );
+	std::string::size_type sep = path.rfind( '/' ) + 1;	// 0 if there is none
+	uint32_t dir = intern( dirIds, dirs, path.substr( 0, sep ) );
+	uint32_t name = intern( nameIds, names, path.substr( sep ) );
+	files.push_back( FileEntry{ dir, name, pos } );
+      }
+    }
+
+    // renumber directories and names in case folded order
+    auto sortedIds = []( const std::vector<const std::string *> & strs_r, std::vector<uint32_t> & order_r, std::vector<uint32_t> & newid_r ) {
+      order_r.resize( strs_r.size() );
+      for ( uint32_t i = 0; i < order_r.size(); ++i )
+	order_r[i] = i;
+      std::sort( order_r.begin(), order_r.end(), [&strs_r]( uint32_t lhs, uint32_t rhs ) {
+	const std::string & l( *strs_r[lhs] );
+	const std::string & r( *strs_r[rhs] );
+	int res = foldcmp( l.data(), l.size(), r.data(), r.size() );
+	return res < 0 || ( res == 0 && l < r );
+      } );
+      newid_r.resize( strs_r.size() );
+      for ( uint32_t i = 0; i < order_r.size(); ++i )
+	newid_r[order_r[i]] = i;
+    };
+    std::vector<uint32_t> dirOrder, dirNewId, nameOrder, nameNewId;
+    sortedIds( dirs, dirOrder, dirNewId );
+    sortedIds( names, nameOrder, nameNewId );
+
+    for ( FileEntry & file : files )
+    {
+      file._dir = dirNewId[file._dir];
+      file._name = nameNewId[file._name];
+    }
+    std::sort( files.begin(), files.end(), []( const FileEntry & lhs, const FileEntry & rhs ) {
+      return lhs._dir < rhs._dir || ( lhs._dir == rhs._dir && ( lhs._name < rhs._name || ( lhs._name == rhs._name && lhs._pos < rhs._pos ) ) );
+    } );
+    files.erase( std::unique( files.begin(), files.end(), []( const FileEntry & lhs, const FileEntry & rhs ) {
+      return lhs._dir == rhs._dir && lhs._name == rhs._name && lhs._pos == rhs._pos;
+    } ), files.end() );
+
+    std::vector<uint32_t> byName( files.size() );
+    for ( uint32_t i = 0; i < byName.size(); ++i )
+      byName[i] = i;
+    std::stable_sort( byName.begin(), byName.end(), [&files]( uint32_t lhs, uint32_t rhs ) {
+      return files[lhs]._name < files[rhs]._name;
+    } );
+
+    std::string strings;
+    std::vector<DirEntry> dirTable( dirs.size(), DirEntry{ 0, 0, 0, 0 } );
+    for ( uint32_t i = 0; i < dirTable.size(); ++i )
+    {
+      const std::string & str( *dirs[dirOrder[i]] );
+      dirTable[i]._strOff = strings.size();
+      dirTable[i]._strLen = str.size();
+      strings += str;
+    }
+    for ( uint32_t i = 0; i < files.size(); ++i )
+    {
+      DirEntry & dir( dirTable[files[i]._dir] );
+      if ( dir._count++ == 0 )
+	dir._first = i;
+    }
+    std::vector<NameEntry> nameTable( names.size() );
+    for ( uint32_t i = 0; i < nameTable.size(); ++i )
+    {
+      const std::string & str( *names[nameOrder[i]] );
+      nameTable[i]._strOff = strings.size();
+      nameTable[i]._strLen = str.size();
+      strings += str;
+    }
+
+    auto asBytes = []( const void * data_r, size_t size_r ) {
+      return std::string( static_cast<const char *>(data_r), size_r );
+    };
+    std::string dirSection( asBytes( dirTable.data(), dirTable.size() * sizeof(DirEntry) ) );
+    std::string nameSection( asBytes( nameTable.data(), nameTable.size() * sizeof(NameEntry) ) );
+    std::string fileSection( asBytes( files.data(), files.size() * sizeof(FileEntry) ) );
+    std::string byNameSection( asBytes( byName.data(), byName.size() * sizeof(uint32_t) ) );
+
+    header_r._count[0] = dirTable.size();
+    header_r._count[1] = nameTable.size();
+    header_r._count[2] = files.size();
+    header_r._count[3] = strings.size();
+    if ( ! writeIndexFile( file_r, header_r, { &dirSection, &nameSection, &fileSection, &byNameSection, &strings } ) )
+      return false;
+
+    MIL << "Path index " << file_r << ": " << files.size() << " files in " << dirTable.size() << " directories, "
+        << ( sizeof(header_r) + dirSection.size() + nameSection.size() + fileSection.size() + byNameSection.size() + strings.size() ) << " bytes" << endl;
+    return true;
+  }
+
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////
+/// \class SearchIndex::MappedFile
+/// \brief A read-only mmapped index file.
+///////////////////////////////////////////////////////////////////
+class SearchIndex::MappedFile
+{
+public:
+  MappedFile( const Pathname & file_r )
+  : _data( nullptr )
+  , _size( 0 )
+  {
+    int fd = ::open( file_r.c_str(), O_RDONLY|O_CLOEXEC );
+    if ( fd < 0 )
+      return;
+    struct stat st;
+    if ( ::fstat( fd, &st ) == 0 && size_t(st.st_size) >= sizeof(FileHeader) )
+    {
+      void * addr = ::mmap( nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+      if ( addr != MAP_FAILED )
+      {
+	_data = static_cast<const char *>(addr);
+	_size = st.st_size;
+      }
+    }
+    ::close( fd );
+  }
+
+  ~MappedFile()
+  { if ( _data ) ::munmap( const_cast<char *>(_data), _size ); }
+
+  /** Whether the file is mapped and was built from the current solv file. */
+  bool valid( const char * magic_r, const PathInfo & solv_r, unsigned solvables_r ) const
+  { return valid( magic_r, solv_r ) && header()._solvables == solvables_r; }
+
+  /** \overload Without knowing the number of solvables (repo not loaded). */
+  bool valid( const char * magic_r, const PathInfo & solv_r ) const
+  { return _data && sameSolvFile( header(), magic_r, solv_r ); }
+
+  const FileHeader & header() const
+  { return *reinterpret_cast<const FileHeader *>(_data); }
+
+  size_t size() const
+  { return _size; }
+
+  /** Pointer to the section at \a offset_r bytes past the header. */
+  template <class Tp>
+  const Tp * section( size_t offset_r ) const
+  { return reinterpret_cast<const Tp *>( _data + sizeof(FileHeader) + offset_r ); }
+
+private:
+  const char * _data;
+  size_t _size;
+};
+
+///////////////////////////////////////////////////////////////////
+
+SearchIndex::SearchIndex( Zypper & zypper_r, const sat::Repository & repo_r )
+{
+  for_( it, repo_r.solvablesBegin(), repo_r.solvablesEnd() )
+    _solvables.push_back( *it );
+
+  Pathname dir( solvCacheDir( zypper_r, repo_r ) );
+  PathInfo solv( dir / "solv" );
+  if ( ! solv.isFile() )
+    return;
+
+  std::unique_ptr<MappedFile> text( new MappedFile( dir / textIndexName ) );
+  if ( text->valid( textIndexMagic, solv, _solvables.size() ) )
+  {
+    // check all offsets once, so lookups don't need to
+    const FileHeader & header( text->header() );
+    bool ok = ( text->size() == sizeof(FileHeader) + header._count[0] * sizeof(WordEntry) + header._count[1] + header._count[2] );
+    const WordEntry * words = text->section<WordEntry>( 0 );
+    for ( uint32_t i = 0; ok && i < header._count[0]; ++i )
+    {
+      ok = ( uint64_t(words[i]._strOff) + words[i]._strLen <= header._count[1]
+	  && uint64_t(words[i]._postOff) + words[i]._postLen <= header._count[2] );
+    }
+    if ( ok )
+      _text = std::move( text );
+    else
+      WAR << "Ignoring broken text index in " << dir << endl;
+  }
+  else
+    DBG << "No up to date text index in " << dir << endl;
+
+  std::unique_ptr<MappedFile> path( new MappedFile( dir / pathIndexName ) );
+  if ( path->valid( pathIndexMagic, solv, _solvables.size() ) )
+  {
+    // check the directory and name tables; file entries are checked when used
+    const FileHeader & header( path->header() );
+    bool ok = ( path->size() == sizeof(FileHeader) + header._count[0] * sizeof(DirEntry) + header._count[1] * sizeof(NameEntry)
+                                + header._count[2] * ( sizeof(FileEntry) + sizeof(uint32_t) ) + header._count[3] );
+    const DirEntry * dirs = path->section<DirEntry>( 0 );
+    for ( uint32_t i = 0; ok && i < header._count[0]; ++i )
+    {
+      ok = ( uint64_t(dirs[i]._strOff) + dirs[i]._strLen <= header._count[3]
+	  && uint64_t(dirs[i]._first) + dirs[i]._count <= header._count[2] );
+    }
+    const NameEntry * names = path->section<NameEntry>( header._count[0] * sizeof(DirEntry) );
+    for ( uint32_t i = 0; ok && i < header._count[1]; ++i )
+      ok = ( uint64_t(names[i]._strOff) + names[i]._strLen <= header._count[3] );
+    if ( ok )
+      _path = std::move( path );
+    else
+      WAR << "Ignoring broken path index in " << dir << endl;
+  }
+  else
+    DBG << "No up to date path index in " << dir << endl;
+}
+
+SearchIndex::~SearchIndex()
+{}
+
+bool SearchIndex::textCandidates( const std::string & term_r, std::vector<sat::Solvable> & result_r ) const
+{
+  if ( ! _text )
+    return false;
+
+  // The words in term_r. A term starting (ending) with a word character
+  // may match the tail (head) of a longer word in the text. All other
+  // words of the term must be complete words in the text as well.
+  struct TermWord
+  {
+    std::string _word;
+    bool _head;	//< starts a word in the text
+    bool _tail;	//< ends a word in the text
+  };
+  std::vector<TermWord> termWords;
+  forEachWord( term_r.c_str(), [&termWords]( const std::string & word_r ) {
+    termWords.push_back( TermWord{ word_r, true, true } );
+  } );
+  if ( termWords.empty() )
+    return false;
+  if ( isWordChar( term_r.front() ) )
+    termWords.front()._head = false;
+  if ( isWordChar( term_r.back() ) )
+    termWords.back()._tail = false;
+
+  const FileHeader & header( _text->header() );
+  const WordEntry * wbegin = _text->section<WordEntry>( 0 );
+  const WordEntry * wend = wbegin + header._count[0];
+  const char * strings = _text->section<char>( header._count[0] * sizeof(WordEntry) );
+  const unsigned char * posts = _text->section<unsigned char>( header._count[0] * sizeof(WordEntry) + header._count[1] );
+
+  // hits[pos] == i: solvable at pos contains the first i term words
+  std::vector<uint32_t> hits( _solvables.size(), 0 );
+  for ( uint32_t i = 0; i < termWords.size(); ++i )
+  {
+    const TermWord & tw( termWords[i] );
+    const char * tws = tw._word.data();
+    size_t twl = tw._word.size();
+
+    // Words are sorted, so those starting with tw are a contiguous range.
+    const WordEntry * wit = wbegin;
+    if ( tw._head )
+    {
+      wit = std::lower_bound( wbegin, wend, tw._word, [strings]( const WordEntry & ent_r, const std::string & word_r ) {
+	int res = ::memcmp( strings + ent_r._strOff, word_r.data(), std::min( size_t(ent_r._strLen), word_r.size() ) );
+	return res < 0 || ( res == 0 && ent_r._strLen < word_r.size() );
+      } );
+    }
+
+    for ( ; wit != wend; ++wit )
+    {
+      const char * ws = strings + wit->_strOff;
+      size_t wl = wit->_strLen;
+      if ( tw._head )
+      {
+	if ( wl < twl || ::memcmp( ws, tws, twl ) != 0 )
+	  break;	// end of range
+	if ( tw._tail && wl != twl )
+	  continue;
+      }
+      else if ( tw._tail )
+      {
+	if ( wl < twl || ::memcmp( ws + wl - twl, tws, twl ) != 0 )
+	  continue;
+      }
+      else if ( ! ::memmem( ws, wl, tws, twl ) )
+	continue;
+
+      const unsigned char * p = posts + wit->_postOff;
+      const unsigned char * e = p + wit->_postLen;
+      uint32_t pos = 0;
+      while ( p < e )
+      {
+	uint32_t delta = 0;
+	for ( unsigned shift = 0; p < e && shift < 35; shift += 7 )
+	{
+	  delta |= uint32_t( *p & 0x7f ) << shift;
+	  if ( ! ( *p++ & 0x80 ) )
+	    break;
+	}
+	pos += delta;
+	if ( pos < hits.size() && hits[pos] == i )
+	  hits[pos] = i + 1;
+      }
+    }
+  }
+
+  for ( uint32_t pos = 0; pos < hits.size(); ++pos )
+  {
+    if ( hits[pos] == termWords.size() )
+      result_r.push_back( _solvables[pos] );
+  }
+  return true;
+}
+
+bool SearchIndex::fileMatches( const std::string & key_r, PathLookup lookup_r,
+                               const StrMatcher & matcher_r,
+                               std::vector<sat::Solvable> & result_r ) const
+{
+  if ( ! _path )
+    return false;
+
+  const FileHeader & header( _path->header() );
+  const uint32_t ndirs = header._count[0];
+  const uint32_t nnames = header._count[1];
+  const uint32_t nfiles = header._count[2];
+  size_t off = 0;
+  const DirEntry * dirs = _path->section<DirEntry>( off );
+  off += ndirs * sizeof(DirEntry);
+  const NameEntry * names = _path->section<NameEntry>( off );
+  off += nnames * sizeof(NameEntry);
+  const FileEntry * files = _path->section<FileEntry>( off );
+  off += nfiles * sizeof(FileEntry);
+  const uint32_t * byName = _path->section<uint32_t>( off );
+  off += nfiles * sizeof(uint32_t);
+  const char * strings = _path->section<char>( off );
+
+  std::vector<bool> hit( _solvables.size(), false );
+  std::string path;
+
+  auto tryFile = [&]( uint32_t idx_r ) {
+    if ( idx_r >= nfiles )
+      return;
+    const FileEntry & file( files[idx_r] );
+    if ( file._dir >= ndirs || file._name >= nnames || file._pos >= hit.size() || hit[file._pos] )
+      return;
+    path.assign( strings + dirs[file._dir]._strOff, dirs[file._dir]._strLen );
+    path.append( strings + names[file._name]._strOff, names[file._name]._strLen );
+    if ( matcher_r.doMatch( path.c_str() ) )
+      hit[file._pos] = true;
+  };
+  auto tryDir = [&]( uint32_t dir_r ) {
+    for ( uint32_t i = 0; i < dirs[dir_r]._count; ++i )
+      tryFile( dirs[dir_r]._first + i );
+  };
+  // files in directory dir_r named [nbegin_r,nend_r)
+  auto tryDirNames = [&]( uint32_t dir_r, uint32_t nbegin_r, uint32_t nend_r ) {
+    const FileEntry * fend = files + dirs[dir_r]._first + dirs[dir_r]._count;
+    const FileEntry * it = std::partition_point( files + dirs[dir_r]._first, fend, [nbegin_r]( const FileEntry & file_r ) {
+      return file_r._name < nbegin_r;
+    } );
+    for ( ; it != fend && it->_name < nend_r; ++it )
+      tryFile( it - files );
+  };
+  // byName range of the files named [nbegin_r,nend_r)
+  auto nameOf = [&]( uint32_t idx_r ) { return idx_r < nfiles ? files[idx_r]._name : UINT_MAX; };
+  auto byNameRange = [&]( uint32_t nbegin_r, uint32_t nend_r ) {
+    const uint32_t * begin = std::partition_point( byName, byName + nfiles, [&]( uint32_t idx_r ) { return nameOf( idx_r ) < nbegin_r; } );
+    const uint32_t * end = std::partition_point( begin, byName + nfiles, [&]( uint32_t idx_r ) { return nameOf( idx_r ) < nend_r; } );
+    return std::make_pair( begin, end );
+  };
+
+  // The key's directory part (up to and including the last '/') and name part.
+  std::string::size_type sep = key_r.rfind( '/' ) + 1;
+  std::string dirKey( key_r, 0, sep );
+  std::string nameKey( key_r, sep );
+
+  switch ( lookup_r )
+  {
+    case PATH_EXACT:
+    {
+      std::pair<uint32_t,uint32_t> drange( foldedRange( dirs, ndirs, strings, dirKey, false ) );
+      std::pair<uint32_t,uint32_t> nrange( foldedRange( names, nnames, strings, nameKey, false ) );
+      for ( uint32_t d = drange.first; d < drange.second; ++d )
+	tryDirNames( d, nrange.first, nrange.second );
+      break;
+    }
+
+    case PATH_PREFIX:
+    {
+      // all files below directories starting with the key...
+      std::pair<uint32_t,uint32_t> drange( foldedRange( dirs, ndirs, strings, key_r, true ) );
+      for ( uint32_t d = drange.first; d < drange.second; ++d )
+	tryDir( d );
+      // ...and those in the key's directory, named like the rest of the key
+      if ( ! nameKey.empty() )
+      {
+	drange = foldedRange( dirs, ndirs, strings, dirKey, false );
+	std::pair<uint32_t,uint32_t> nrange( foldedRange( names, nnames, strings, nameKey, true ) );
+	for ( uint32_t d = drange.first; d < drange.second; ++d )
+	  tryDirNames( d, nrange.first, nrange.second );
+      }
+      break;
+    }
+
+    case PATH_SUBSTRING:
+    {
+      // The key is either within the directory, or (as names contain no '/')
+      // within the name if it has no '/', or else its last '/' is the
+      // directory's trailing one.
+      std::string key( folded( key_r ) );
+      for ( uint32_t d = 0; d < ndirs; ++d )
+      {
+	if ( foldedContains( strings + dirs[d]._strOff, dirs[d]._strLen, key ) )
+	  tryDir( d );
+      }
+      if ( dirKey.empty() )
+      {
+	for ( uint32_t n = 0; n < nnames; ++n )
+	{
+	  if ( ! foldedContains( strings + names[n]._strOff, names[n]._strLen, key ) )
+	    continue;
+	  auto range( byNameRange( n, n+1 ) );
+	  for ( const uint32_t * it = range.first; it != range.second; ++it )
+	    tryFile( *it );
+	}
+      }
+      else if ( ! nameKey.empty() )
+      {
+	std::pair<uint32_t,uint32_t> nrange( foldedRange( names, nnames, strings, nameKey, true ) );
+	auto range( byNameRange( nrange.first, nrange.second ) );
+	for ( const uint32_t * it = range.first; it != range.second; ++it )
+	{
+	  if ( *it >= nfiles || files[*it]._dir >= ndirs )
+	    continue;
+	  const DirEntry & dir( dirs[files[*it]._dir] );
+	  if ( dir._strLen >= dirKey.size()
+	    && foldcmp( strings + dir._strOff + dir._strLen - dirKey.size(), dirKey.size(), dirKey.data(), dirKey.size() ) == 0 )
+	    tryFile( *it );
+	}
+      }
+      break;
+    }
+
+    case PATH_ALL:
+      for ( uint32_t i = 0; i < nfiles; ++i )
+	tryFile( i );
+      break;
+  }
+
+  for ( uint32_t pos = 0; pos < hit.size(); ++pos )
+  {
+    if ( hit[pos] )
+      result_r.push_back( _solvables[pos] );
+  }
+  return true;
+}
+
+bool SearchIndex::completeNames( const Pathname & dir_r, const std::string & prefix_r, std::vector<std::string> & result_r )
+{
+  PathInfo solv( dir_r / "solv" );
+  if ( ! solv.isFile() )
+    return false;
+
+  MappedFile names( dir_r / nameIndexName );
+  if ( ! names.valid( nameIndexMagic, solv ) )
+    return false;
+
+  const FileHeader & header( names.header() );
+  uint32_t count = header._count[0];
+  uint32_t strsize = header._count[1];
+  if ( names.size() != sizeof(FileHeader) + count * sizeof(uint32_t) + strsize
+    || ( strsize && names.section<char>( count * sizeof(uint32_t) )[strsize-1] != '\0' ) )
+  {
+    WAR << "Ignoring broken name index in " << dir_r << endl;
+    return false;
+  }
+
+  const uint32_t * table = names.section<uint32_t>( 0 );
+  const char * strings = names.section<char>( count * sizeof(uint32_t) );
+  auto name = [&]( uint32_t idx_r ) -> const char * {
+    return table[idx_r] < strsize ? strings + table[idx_r] : "";
+  };
+
+  // lower bound of the prefix, then all names starting with it
+  uint32_t lo = 0;
+  uint32_t hi = count;
+  while ( lo < hi )
+  {
+    uint32_t mid = lo + ( hi - lo ) / 2;
+    if ( ::strcmp( name( mid ), prefix_r.c_str() ) < 0 )
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  for ( ; lo < count && ::strncmp( name( lo ), prefix_r.c_str(), prefix_r.size() ) == 0; ++lo )
+    result_r.push_back( name( lo ) );
+  return true;
+}
+
+bool SearchIndex::update( Zypper & zypper_r, const sat::Repository & repo_r, Indexes which_r )
+{
+  Pathname dir( solvCacheDir( zypper_r, repo_r ) );
+  PathInfo solv( dir / "solv" );
+  if ( ! solv.isFile() || ::access( dir.c_str(), W_OK ) != 0 )
+    return false;
+
+  SearchIndex current( zypper_r, repo_r );
+  bool needText = ( which_r & TEXT_INDEX ) && ! current.hasTextIndex();
+  bool needPath = ( which_r & PATH_INDEX ) && ! current.hasPathIndex();
+  bool needName = ( which_r & NAME_INDEX ) && ! indexFileUpToDate( dir / nameIndexName, nameIndexMagic, solv );
+  if ( ! ( needText || needPath || needName ) )
+    return false;
+
+  MIL << "Building search index for " << repo_r.alias() << endl;
+  bool written = false;
+  if ( needText
+    && buildTextIndex( dir / textIndexName, makeHeader( textIndexMagic, solv, current._solvables.size() ), current._solvables ) )
+    written = true;
+  if ( needPath
+    && buildPathIndex( dir / pathIndexName, makeHeader( pathIndexMagic, solv, current._solvables.size() ), current._solvables ) )
+    written = true;
+  if ( needName
+    && buildNameIndex( dir / nameIndexName, makeHeader( nameIndexMagic, solv, current._solvables.size() ), current._solvables ) )
+    written = true;
+  return written;
+}
+
+bool SearchIndex::update( Zypper & zypper_r, const RepoInfo & repo_r )
+{
+  Pathname dir( solvCacheDir( zypper_r, repo_r ) );
+  PathInfo solv( dir / "solv" );
+  if ( ! solv.isFile() || ::access( dir.c_str(), W_OK ) != 0 )
+    return false;
+  if ( indexFileUpToDate( dir / textIndexName, textIndexMagic, solv )
+    && indexFileUpToDate( dir / pathIndexName, pathIndexMagic, solv )
+    && indexFileUpToDate( dir / nameIndexName, nameIndexMagic, solv ) )
+    return false;
+
+  sat::Repository repo( sat::Pool::instance().reposFind( repo_r.alias() ) );
+  if ( repo == sat::Repository::noRepository )
+  {
+    try
+    {
+      zypper_r.repoManager().loadFromCache( repo_r );
+    }
+    catch ( const Exception & e )
+    {
+      ZYPP_CAUGHT( e );
+      WAR << "Can't load " << repo_r.alias() << " to build its search index" << endl;
+      return false;
+    }
+    repo = sat::Pool::instance().reposFind( repo_r.alias() );
+  }
+  return update( zypper_r, repo );
+}
@@ -0,0 +1,131 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#ifndef ZYPPER_SEARCHINDEX_H
+#define ZYPPER_SEARCHINDEX_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <zypp/Pathname.h>
+#include <zypp/RepoInfo.h>
+#include <zypp/base/StrMatcher.h>
+#include <zypp/sat/Repository.h>
+#include <zypp/sat/Solvable.h>
+
+class Zypper;
+
+///////////////////////////////////////////////////////////////////
+/// \class SearchIndex
+/// \brief Per repository search index stored next to the solv file.
+///
+/// The text index maps the (case folded) words of all solvables'
+/// summaries and descriptions to the solvables containing them. It
+/// is used to find the few candidates a search string may match in,
+/// before the exact match is done the usual way.
+///
+/// The path index is a table of all file list entries (split into
+/// directory and base name), sorted case folded by directory and by
+/// name. Exact, prefix and substring lookups only look at the matching
+/// table ranges, and only the paths found there are matched exactly.
+///
+/// The name index is the sorted list of the repo's solvable idents
+/// (\c name, \c patch:name, ...). It answers prefix queries for shell
+/// completion (\ref completeNames) without loading the repo.
+///
+/// Index files are bound to the solv file they were built from (size
+/// and mtime) and are ignored once it changes. They are (re)built by
+/// \ref update when refreshing and after loading a repo (so a solv file
+/// rebuilt by an autorefresh gets fresh indexes), and for the name index
+/// of the system repo when loading it. Searches without an index fall
+/// back to scanning the repo.
+///////////////////////////////////////////////////////////////////
+class SearchIndex
+{
+public:
+  /** Open the index files of the loaded \a repo_r, if present and up to date.
+   * The system repo is indexed, too, if its solv file is in our solv cache.
+   */
+  SearchIndex( Zypper & zypper_r, const zypp::sat::Repository & repo_r );
+  ~SearchIndex();
+
+  SearchIndex( const SearchIndex & ) = delete;
+  SearchIndex & operator=( const SearchIndex & ) = delete;
+
+  /** All solvables of the repo, in pool order. */
+  const std::vector<zypp::sat::Solvable> & solvables() const
+  { return _solvables; }
+
+  /** Whether a usable text index is present. */
+  bool hasTextIndex() const
+  { return bool(_text); }
+
+  /** Whether a usable path index is present. */
+  bool hasPathIndex() const
+  { return bool(_path); }
+
+  /** Solvables (in pool order) whose summary or description may
+   * contain \a term_r, ignoring case.
+   * \return \c false if the index can't tell (no index, or \a term_r
+   * contains no word characters); \a result_r is not touched then.
+   */
+  bool textCandidates( const std::string & term_r, std::vector<zypp::sat::Solvable> & result_r ) const;
+
+  /** How to look up \ref fileMatches candidates. */
+  enum PathLookup
+  {
+    PATH_EXACT,		//< path equals key (ignoring case)
+    PATH_PREFIX,	//< path starts with key (ignoring case)
+    PATH_SUBSTRING,	//< path contains key (ignoring case)
+    PATH_ALL		//< every path is a candidate
+  };
+
+  /** Solvables (in pool order) having a file whose full path matches \a matcher_r.
+   * Only the paths selected by \a key_r and \a lookup_r are tried, so
+   * every path \a matcher_r may match must be one of them.
+   * \return \c false if there is no path index; \a result_r is not touched then.
+   */
+  bool fileMatches( const std::string & key_r, PathLookup lookup_r,
+                    const zypp::StrMatcher & matcher_r,
+                    std::vector<zypp::sat::Solvable> & result_r ) const;
+
+public:
+  /** Solvable idents (\c name, \c patch:name, ...) starting with \a prefix_r,
+   * in byte order, looked up in the name index in the solv cache directory
+   * \a dir_r. Nothing needs to be loaded for this.
+   * \return \c false if there is no up to date name index; \a result_r is not touched then.
+   */
+  static bool completeNames( const zypp::Pathname & dir_r, const std::string & prefix_r, std::vector<std::string> & result_r );
+
+  /** Index files to \ref update. */
+  enum Indexes
+  {
+    TEXT_INDEX	= 1 << 0,
+    PATH_INDEX	= 1 << 1,
+    NAME_INDEX	= 1 << 2,
+    ALL_INDEXES	= TEXT_INDEX | PATH_INDEX | NAME_INDEX
+  };
+
+  /** (Re)build the index files (\a which_r of them) of the loaded \a repo_r unless they are up to date.
+   * Nothing is done if the cache is not writable.
+   * \return whether index files were written.
+   */
+  static bool update( Zypper & zypper_r, const zypp::sat::Repository & repo_r, Indexes which_r = ALL_INDEXES );
+
+  /** \overload Loads \a repo_r from the cache if necessary. */
+  static bool update( Zypper & zypper_r, const zypp::RepoInfo & repo_r );
+
+private:
+  class MappedFile;
+
+  std::vector<zypp::sat::Solvable> _solvables;	//< index position => solvable
+  std::unique_ptr<MappedFile> _text;
+  std::unique_ptr<MappedFile> _path;
+};
+
+#endif // ZYPPER_SEARCHINDEX_H
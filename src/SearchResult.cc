@@ -0,0 +1,144 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#include <algorithm>
+
+#include <zypp/base/Logger.h>
+#include <zypp/Patch.h>
+#include <zypp/PoolItem.h>
+
+#include "main.h"
+#include "Zypper.h"
+#include "Table.h"
+#include "utils/misc.h" // for kind_to_string_localized and string_patch_status
+
+#include "SearchResult.h"
+
+using namespace zypp;
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  /** Stable sort \a rows_r by \a key_r of the rows. */
+  template <class Key>
+  void stableSortBy( SearchResult::container & rows_r, Key key_r )
+  {
+    std::stable_sort( rows_r.begin(), rows_r.end(), [&]( const SearchResult::Row & lhs, const SearchResult::Row & rhs ) {
+      return key_r( lhs ) < key_r( rhs );
+    } );
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+void SearchResult::sortByName()
+{
+  stableSortBy( _rows, []( const Row & row_r ) { return row_r._solvable.name(); } );
+}
+
+void SearchResult::sortByRepo()
+{
+  stableSortBy( _rows, []( const Row & row_r ) { return repoString( row_r._solvable ); } );
+}
+
+std::string SearchResult::repoString( sat::Solvable solv_r )
+{
+  if ( solv_r.isSystem() )
+    return std::string("(") + _("System Packages") + ")";
+  return solv_r.repository().asUserString();
+}
+
+const char * SearchResult::statusTag( const Row & row_r )
+{
+  switch ( row_r._status )
+  {
+    case INSTALLED:	return row_r._locked ? "il" : "i";
+    case OTHER_VERSION:	return row_r._locked ? "vl" : "v";
+    case NOT_INSTALLED:	return row_r._locked ? " l" : "";
+  }
+  INT << "unknown status " << row_r._status << endl;
+  return "?L";	// should not happen
+}
+
+void SearchResult::fillTable( Table & table_r ) const
+{
+  switch ( _style )
+  {
+    case SELECTABLES:
+      table_r << ( TableHeader()
+	      // translators: S for installed Status
+	      << _("S")
+	      << _("Name")
+	      // translators: package summary (header)
+	      << _("Summary")
+	      << _("Type") );
+      if ( ! Zypper::instance()->globalOpts().no_abbrev )
+	table_r.allowAbbrev( 2 );
+      break;
+
+    case SOLVABLES:
+      table_r << ( TableHeader()
+	      // translators: S for 'installed Status'
+	      << _("S")
+	      // translators: name (general header)
+	      << _("Name")
+	      // translators: type (general header)
+	      << _("Type")
+	      // translators: package version (header)
+	      << table::EditionStyleSetter( table_r, _("Version") )
+	      // translators: package architecture (header)
+	      << _("Arch")
+	      // translators: package's repository (header)
+	      << _("Repository") );
+      break;
+
+    case PATCHES:
+      table_r << ( TableHeader()
+	      << _("Repository")
+	      << _("Name")
+	      << _("Category")
+	      << _("Severity")
+	      << _("Status") );
+      break;
+  }
+
+  for_( it, _rows.begin(), _rows.end() )
+  {
+    PoolItem pi( it->_solvable );
+    TableRow row;
+    switch ( _style )
+    {
+      case SELECTABLES:
+	row << statusTag( *it )
+	    << pi->name()
+	    << pi->summary()
+	    << kind_to_string_localized( pi->kind(), 1 );
+	break;
+
+      case SOLVABLES:
+	row << statusTag( *it )
+	    << pi->name()
+	    << kind_to_string_localized( pi->kind(), 1 )
+	    << pi->edition().asString()
+	    << pi->arch().asString()
+	    << repoString( it->_solvable );
+	break;
+
+      case PATCHES:
+      {
+	Patch::constPtr patch( asKind<Patch>( pi.resolvable() ) );
+	row << pi.repository().asUserString()
+	    << pi.name()
+	    << patch->category()
+	    << patch->severity()
+	    << string_patch_status( pi );
+	break;
+      }
+    }
+    for_( dit, it->_details.begin(), it->_details.end() )
+      row.addDetail( *dit );
+    table_r << std::move( row );
+  }
+}
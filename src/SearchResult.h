@@ -0,0 +1,107 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#ifndef ZYPPER_SEARCHRESULT_H
+#define ZYPPER_SEARCHRESULT_H
+
+#include <string>
+#include <vector>
+
+#include <zypp/sat/Solvable.h>
+
+class Table;
+
+///////////////////////////////////////////////////////////////////
+/// \class SearchResult
+/// \brief The rows found by a search, as data.
+///
+/// Filled by the \c FillSearchTable* functors (search.h) and rendered
+/// by \ref Out::searchResult. Columns are computed from the row's
+/// solvable by the renderer, so machine readable output doesn't need to
+/// format (and parse back) a \ref Table.
+///////////////////////////////////////////////////////////////////
+class SearchResult
+{
+public:
+  /** What the rows stand for; determines the columns shown. */
+  enum Style
+  {
+    SELECTABLES,	//< S | Name | Summary | Type
+    SOLVABLES,		//< S | Name | Type | Version | Arch | Repository	(search --details)
+    PATCHES		//< Repository | Name | Category | Severity | Status	(patch-search)
+  };
+
+  /** Installed status of a row. */
+  enum Status
+  {
+    NOT_INSTALLED,
+    INSTALLED,		//< exactly this version is installed (patches: satisfied)
+    OTHER_VERSION	//< installed, but in a different version
+  };
+
+  struct Row
+  {
+    Row( zypp::sat::Solvable solvable_r, Status status_r, bool locked_r = false )
+    : _solvable( solvable_r ), _status( status_r ), _locked( locked_r )
+    {}
+
+    zypp::sat::Solvable _solvable;	//< for SELECTABLES the selectable's \c theObj
+    Status _status;
+    bool _locked;
+    std::vector<std::string> _details;	//< where the search matched (search --verbose)
+  };
+
+  typedef std::vector<Row> container;
+
+public:
+  explicit SearchResult( Style style_r = SELECTABLES )
+  : _style( style_r )
+  {}
+
+  Style style() const
+  { return _style; }
+
+  void setStyle( Style style_r )
+  { _style = style_r; }
+
+  bool empty() const
+  { return _rows.empty(); }
+
+  container::size_type size() const
+  { return _rows.size(); }
+
+  const container & rows() const
+  { return _rows; }
+
+  container & rows()
+  { return _rows; }
+
+  void add( Row row_r )
+  { _rows.push_back( std::move( row_r ) ); }
+
+  /** Stable sort by name. */
+  void sortByName();
+
+  /** Stable sort by repository (as shown). */
+  void sortByRepo();
+
+  /** Header and rows as shown in the table. */
+  void fillTable( Table & table_r ) const;
+
+public:
+  /** Repository column text of \a solv_r. */
+  static std::string repoString( zypp::sat::Solvable solv_r );
+
+  /** Status column text of \a row_r (styles SELECTABLES and SOLVABLES). */
+  static const char * statusTag( const Row & row_r );
+
+private:
+  Style _style;
+  container _rows;
+};
+
+#endif // ZYPPER_SEARCHRESULT_H
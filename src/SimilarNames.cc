@@ -0,0 +1,228 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#include <algorithm>
+#include <map>
+#include <memory>
+
+#include <zypp/base/Easy.h>
+#include <zypp/base/Logger.h>
+#include <zypp/base/String.h>
+#include <zypp/base/SerialNumber.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/sat/Solvable.h>
+
+#include "main.h"
+#include "SimilarNames.h"
+
+using namespace zypp;
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  /** Time allowed for a suggestion, including building the index on first use. */
+  const std::chrono::milliseconds timeBudget( 200 );
+
+  /** The deadline is checked every this many names. */
+  const unsigned checkEvery = 1024;
+
+  /** Leading and trailing pad byte, so the first and last chars are part of 3 trigrams, too. */
+  const unsigned char pad = '\x01';
+
+  inline unsigned trigram( unsigned char a, unsigned char b, unsigned char c )
+  { return ( unsigned(a) << 16 ) | ( unsigned(b) << 8 ) | c; }
+
+  /** The distinct trigrams of \a str_r (padded). */
+  std::vector<unsigned> trigrams( const std::string & str_r )
+  {
+    std::string padded( 2, pad );
+    padded += str_r;
+    padded += pad;
+    std::vector<unsigned> ret;
+    for ( std::string::size_type i = 0; i + 2 < padded.size(); ++i )
+      ret.push_back( trigram( padded[i], padded[i+1], padded[i+2] ) );
+    std::sort( ret.begin(), ret.end() );
+    ret.erase( std::unique( ret.begin(), ret.end() ), ret.end() );
+    return ret;
+  }
+
+  /** Levenshtein distance of \a lhs and \a rhs, or <tt>max_r+1</tt> if it exceeds \a max_r. */
+  unsigned distance( const std::string & lhs, const std::string & rhs, unsigned max_r )
+  {
+    unsigned llen = lhs.size();
+    unsigned rlen = rhs.size();
+    if ( ( llen > rlen ? llen - rlen : rlen - llen ) > max_r )
+      return max_r + 1;
+
+    std::vector<unsigned> prev( rlen + 1 );
+    std::vector<unsigned> cur( rlen + 1 );
+    for ( unsigned j = 0; j <= rlen; ++j )
+      prev[j] = j;
+
+    for ( unsigned i = 1; i <= llen; ++i )
+    {
+      cur[0] = i;
+      unsigned rowMin = i;
+      for ( unsigned j = 1; j <= rlen; ++j )
+      {
+	cur[j] = std::min( std::min( prev[j] + 1, cur[j-1] + 1 ),
+			   prev[j-1] + ( lhs[i-1] == rhs[j-1] ? 0 : 1 ) );
+	rowMin = std::min( rowMin, cur[j] );
+      }
+      if ( rowMin > max_r )
+	return max_r + 1;
+      prev.swap( cur );
+    }
+    return std::min( prev[rlen], max_r + 1 );
+  }
+
+  /** Edit distance still considered similar. */
+  inline unsigned maxDistance( const std::string & name_r )
+  { return name_r.size() <= 4 ? 1 : name_r.size() <= 12 ? 2 : 3; }
+
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+SimilarNames::SimilarNames( const ResKind & kind_r, Deadline deadline_r )
+: _kind( kind_r )
+, _next( sat::Pool::instance().solvablesBegin() )
+, _complete( false )
+{
+  resume( deadline_r );
+}
+
+void SimilarNames::resume( Deadline deadline_r )
+{
+  if ( _complete )
+    return;
+
+  const sat::Pool & pool( sat::Pool::instance() );
+  unsigned cnt = 0;
+  for ( ; _next != pool.solvablesEnd(); ++_next )
+  {
+    if ( ++cnt % checkEvery == 0 && std::chrono::steady_clock::now() > deadline_r )
+      break;
+    if ( ! _next->isKind( _kind ) || ! _seen.insert( _next->ident().id() ).second )
+      continue;
+
+    unsigned idx = _names.size();
+    _names.push_back( _next->name() );
+    _folded.push_back( str::toLower( _names.back() ) );
+    for ( unsigned tri : trigrams( _folded.back() ) )
+      _trigrams[tri].push_back( idx );
+  }
+  if ( _next == pool.solvablesEnd() )
+  {
+    _complete = true;
+    std::unordered_set<IdString::IdType>().swap( _seen );
+  }
+  MIL << "Indexed " << _names.size() << " " << _kind << " names"
+      << ( _complete ? "" : " (incomplete, out of time)" ) << endl;
+}
+
+std::vector<std::string> SimilarNames::find( const std::string & name_r, unsigned max_r, Deadline deadline_r ) const
+{
+  std::string folded( str::toLower( name_r ) );
+  unsigned maxDist = maxDistance( folded );
+
+  // Candidates share at least 'need' trigrams (each edit destroys at most 3).
+  std::vector<unsigned> grams( trigrams( folded ) );
+  int need = int(grams.size()) - 3 * int(maxDist);
+
+  std::vector<unsigned> candidates;
+  if ( need > 0 )
+  {
+    std::vector<unsigned short> shared( _names.size() );
+    for ( unsigned tri : grams )
+    {
+      auto it = _trigrams.find( tri );
+      if ( it == _trigrams.end() )
+	continue;
+      for ( unsigned idx : it->second )
+      {
+	if ( ++shared[idx] == need )
+	  candidates.push_back( idx );
+      }
+    }
+  }
+  else
+  {
+    // too short to filter by trigrams; the length check in distance() is cheap
+    candidates.resize( _names.size() );
+    for ( unsigned i = 0; i < candidates.size(); ++i )
+      candidates[i] = i;
+  }
+
+  std::vector<std::pair<unsigned,unsigned>> hits;	// (distance, index)
+  unsigned cnt = 0;
+  for ( unsigned idx : candidates )
+  {
+    if ( ++cnt % checkEvery == 0 && std::chrono::steady_clock::now() > deadline_r )
+    {
+      WAR << "Out of time looking for names similar to '" << name_r << "'" << endl;
+      break;
+    }
+    if ( _names[idx] == name_r )
+      continue;
+    unsigned dist = distance( folded, _folded[idx], maxDist );
+    if ( dist <= maxDist )
+      hits.push_back( std::make_pair( dist, idx ) );
+  }
+
+  std::sort( hits.begin(), hits.end(), [this]( const std::pair<unsigned,unsigned> & lhs, const std::pair<unsigned,unsigned> & rhs ) {
+    return lhs.first < rhs.first || ( lhs.first == rhs.first && _names[lhs.second] < _names[rhs.second] );
+  } );
+
+  std::vector<std::string> ret;
+  for ( unsigned i = 0; i < hits.size() && i < max_r; ++i )
+    ret.push_back( _names[hits[i].second] );
+  DBG << "'" << name_r << "': " << candidates.size() << " candidates, " << hits.size() << " similar" << endl;
+  return ret;
+}
+
+std::vector<std::string> SimilarNames::suggest( const ResKind & kind_r, const std::string & name_r )
+{
+  if ( name_r.empty() || name_r[0] == '/' || name_r.find_first_of( "*?[" ) != std::string::npos )
+    return std::vector<std::string>();
+
+  Deadline deadline( std::chrono::steady_clock::now() + timeBudget );
+
+  static SerialNumberWatcher poolWatcher;
+  static std::map<ResKind, std::unique_ptr<SimilarNames>> indexes;
+  if ( poolWatcher.remember( sat::Pool::instance().serial() ) )
+    indexes.clear();
+
+  // An index cut by the deadline is completed on the next call (each
+  // suggestion gets its own time budget).
+  std::unique_ptr<SimilarNames> & index( indexes[kind_r] );
+  if ( ! index )
+    index.reset( new SimilarNames( kind_r, deadline ) );
+  else if ( ! index->complete() )
+    index->resume( deadline );
+
+  return index->find( name_r, 3, deadline );
+}
+
+std::string SimilarNames::didYouMean( const ResKind & kind_r, const std::string & name_r )
+{
+  std::vector<std::string> names( suggest( kind_r, name_r ) );
+  if ( names.empty() )
+    return std::string();
+
+  if ( names.size() == 1 )
+    // translators: %s is a package (or pattern, patch, ...) name
+    return str::Format(_("Did you mean '%s'?")) % names.front();
+
+  std::string list;
+  for_( it, names.begin(), names.end() )
+  {
+    if ( ! list.empty() )
+      list += ", ";
+    list += "'" + *it + "'";
+  }
+  // translators: %s is a comma separated list of package (or pattern, patch, ...) names
+  return str::Format(_("Did you mean one of these: %s?")) % list;
+}
@@ -0,0 +1,74 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#ifndef ZYPPER_SIMILARNAMES_H
+#define ZYPPER_SIMILARNAMES_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
+
+#include <zypp/ResKind.h>
+#include <zypp/sat/Pool.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class SimilarNames
+/// \brief Trigram index over the names of the solvables in the pool,
+/// used to suggest the names closest to a misspelled one.
+///
+/// Names are indexed case folded. A name within edit distance \c k of
+/// the misspelled one shares all but at most <tt>3*k</tt> of its trigrams,
+/// so only the names sharing enough trigrams are compared using the
+/// (bounded) Levenshtein distance.
+///
+/// Both building the index and looking up names give up once the
+/// deadline passed, returning what was found until then. An incomplete
+/// index is completed by \ref resume.
+///////////////////////////////////////////////////////////////////
+class SimilarNames
+{
+public:
+  typedef std::chrono::steady_clock::time_point Deadline;
+
+  /** Index the names of all solvables of \a kind_r in the pool. */
+  SimilarNames( const zypp::ResKind & kind_r, Deadline deadline_r );
+
+  /** Whether the index is complete (the deadline did not cut its building). */
+  bool complete() const
+  { return _complete; }
+
+  /** Continue building an incomplete index where the deadline cut it.
+   * The pool must not have changed meanwhile.
+   */
+  void resume( Deadline deadline_r );
+
+  /** Up to \a max_r names closest to \a name_r (but not equal to it), closest first. */
+  std::vector<std::string> find( const std::string & name_r, unsigned max_r, Deadline deadline_r ) const;
+
+public:
+  /** Names of \a kind_r similar to \a name_r, using an index built on
+   * first use (and rebuilt if the pool changes). Empty if \a name_r is no
+   * plain name (wildcards, paths), or nothing similar is found in time.
+   */
+  static std::vector<std::string> suggest( const zypp::ResKind & kind_r, const std::string & name_r );
+
+  /** "Did you mean ...?" hint for \a name_r, or an empty string (see \ref suggest). */
+  static std::string didYouMean( const zypp::ResKind & kind_r, const std::string & name_r );
+
+private:
+  std::vector<std::string> _names;		//< names as they are
+  std::vector<std::string> _folded;		//< names case folded
+  std::unordered_map<unsigned, std::vector<unsigned>> _trigrams;	//< trigram => indices of names containing it
+  zypp::ResKind _kind;
+  zypp::sat::Pool::SolvableIterator _next;	//< next solvable to index unless complete
+  std::unordered_set<zypp::IdString::IdType> _seen;	//< idents indexed so far (while incomplete)
+  bool _complete;
+};
+
+#endif // ZYPPER_SIMILARNAMES_H
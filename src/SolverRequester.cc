@@ -10,11 +10,15 @@
  *
  */
 
+#include <algorithm>
+#include <unordered_map>
+
 #include <zypp/ZYppFactory.h>
 #include <zypp/base/LogTools.h>
 
 #include <zypp/PoolQuery.h>
 #include <zypp/PoolItemBest.h>
+#include <zypp/sat/Pool.h>
 
 #include <zypp/Capability.h>
 #include <zypp/Resolver.h>
@@ -52,6 +56,71 @@ void SolverRequester::Options::setForceByName( bool value )
 }
 
 
+/////////////////////////////////////////////////////////////////////////
+// SolverRequester::NameIndex
+/////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+  /** Minimum number of arguments for which building the \ref NameIndex pays off. */
+  const PackageArgs::PackageSpecSet::size_type nameIndexThreshold = 8;
+
+  /** Whether \a name_r would be matched as glob by \ref pkg_spec_to_poolquery. */
+  inline bool isGlob( const std::string & name_r )
+  { return name_r.find_first_of( "*?[" ) != std::string::npos; }
+} // namespace
+
+/**
+ * Case insensitive ident index of all solvables in the pool.
+ *
+ * Image recipes pass thousands of package names to install. Running a
+ * \ref PoolQuery per name scans the whole pool each time. The index is
+ * built in a single pass and turns each plain name into a hash lookup.
+ * It mimics the PoolQuery built by \ref pkg_spec_to_poolquery.
+ *
+ * \note The index is a snapshot of the pool; it must not outlive
+ * a change of the pools content.
+ */
+struct SolverRequester::NameIndex
+{
+  NameIndex()
+  {
+    const sat::Pool & satpool( sat::Pool::instance() );
+    for_( it, satpool.solvablesBegin(), satpool.solvablesEnd() )
+      _index[str::toLower( it->ident().asString() )].push_back( *it );
+    MIL << "Indexed " << _index.size() << " idents." << endl;
+  }
+
+  /** Append items matching \a cap_r by name to \a result_r. */
+  void lookup( const Capability & cap_r, const std::list<std::string> & repos_r, std::vector<PoolItem> & result_r ) const
+  {
+    CapDetail detail( cap_r.detail() );
+    sat::Solvable::SplitIdent splid( detail.name() );
+
+    Index::const_iterator it( _index.find( str::toLower( splid.ident().asString() ) ) );
+    if ( it == _index.end() )
+      return;
+
+    Arch arch( detail.arch() );
+    Edition::MatchRange range( detail.op(), detail.ed() );	// Rel::ANY if not versioned
+    for ( const sat::Solvable & solv : it->second )
+    {
+      if ( ! repos_r.empty()
+	&& std::find( repos_r.begin(), repos_r.end(), solv.repository().alias() ) == repos_r.end() )
+	continue;
+      if ( arch != Arch_empty && solv.arch() != arch )
+	continue;
+      if ( detail.isVersioned() && ! overlaps( Edition::MatchRange( Rel::EQ, solv.edition() ), range ) )
+	continue;
+      result_r.push_back( PoolItem( solv ) );
+    }
+  }
+
+private:
+  typedef std::unordered_map<std::string, std::vector<sat::Solvable>> Index;
+  Index _index;
+};
+
 /////////////////////////////////////////////////////////////////////////
 // SolverRequester
 /////////////////////////////////////////////////////////////////////////
@@ -84,6 +153,8 @@ void SolverRequester::installRemove( const PackageArgs & args )
   if ( args.empty() )
     return;
 
+  prepareNameIndex( args );
+
   for_( it, args.dos().begin(), args.dos().end() )
     install( *it );
 
@@ -98,6 +169,37 @@ void SolverRequester::installRemove( const PackageArgs & args )
 
 // ----------------------------------------------------------------------------
 
+void SolverRequester::prepareNameIndex( const PackageArgs & args )
+{
+  if ( _nameIndex || _opts.force_by_cap )
+    return;
+
+  if ( args.dos().size() + args.donts().size() >= nameIndexThreshold )
+  {
+    MIL << "Batched name lookup for " << args.dos().size() + args.donts().size() << " arguments." << endl;
+    _nameIndex.reset( new NameIndex );
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+std::vector<PoolItem> SolverRequester::matchByName( const PackageSpec & pkg, const std::list<std::string> & repos ) const
+{
+  std::vector<PoolItem> ret;
+  if ( _nameIndex && ! isGlob( pkg.parsed_cap.detail().name().asString() ) )
+  {
+    _nameIndex->lookup( pkg.parsed_cap, repos, ret );
+  }
+  else
+  {
+    PoolQuery q = pkg_spec_to_poolquery( pkg.parsed_cap, repos );
+    ret.assign( q.poolItemBegin(), q.poolItemEnd() );
+  }
+  return ret;
+}
+
+// ----------------------------------------------------------------------------
+
 /*
  * For given Capability & repo & Options:
  *
@@ -128,14 +230,15 @@ void SolverRequester::install( const PackageSpec & pkg )
 
   if ( !_opts.force_by_cap )
   {
-    PoolQuery q = pkg_spec_to_poolquery( pkg.parsed_cap, _opts.from_repos );
+    std::list<std::string> repos( _opts.from_repos );
     if ( !pkg.repo_alias.empty() )
-      q.addRepo( pkg.repo_alias );
+      repos.push_back( pkg.repo_alias );
+    const std::vector<PoolItem> & matches( matchByName( pkg, repos ) );
 
     // get the best matching items and tag them for installation.
     // FIXME this ignores vendor lock - we need some way to do --from which
     // would respect vendor lock: e.g. a new Selectable::updateCandidateObj(Options&)
-    PoolItemBest bestMatches( q.begin(), q.end() );
+    PoolItemBest bestMatches( matches.begin(), matches.end() );
     if ( !bestMatches.empty() )
     {
       unsigned notInstalled = 0;
@@ -248,12 +351,12 @@ void SolverRequester::remove( const PackageSpec & pkg )
 
   if ( !_opts.force_by_cap )
   {
-    PoolQuery q = pkg_spec_to_poolquery( pkg.parsed_cap, "" );
+    const std::vector<PoolItem> & matches( matchByName( pkg, std::list<std::string>() ) );
 
-    if ( !q.empty() )
+    if ( !matches.empty() )
     {
       bool got_installed = false;
-      for_( it, q.poolItemBegin(), q.poolItemEnd() )
+      for_( it, matches.begin(), matches.end() )
       {
         if ( it->status().isInstalled() )
         {
@@ -318,6 +421,7 @@ void SolverRequester::update(const PackageArgs & args)
     return;
 
   _command = ZypperCommand::UPDATE;
+  prepareNameIndex( args );
 
   for_( it, args.dos().begin(), args.dos().end() )
     install( *it );
@@ -14,6 +14,7 @@
 #define SOLVERREQUESTER_H_
 
 #include <string>
+#include <vector>
 
 #include <zypp/ZConfig.h>
 #include <zypp/Date.h>
@@ -363,6 +364,19 @@ public:
 private:
   void installRemove( const PackageArgs & args );
 
+  /**
+   * Build the \ref NameIndex if \a args are many enough to make a
+   * single pass over the pool cheaper than a \ref PoolQuery per argument.
+   */
+  void prepareNameIndex( const PackageArgs & args );
+
+  /**
+   * Items matching \a pkg by name (kind, edition, arch), restricted to
+   * \a repos if not empty. Looked up in the \ref NameIndex if available
+   * and \a pkg contains no glob, otherwise via \ref pkg_spec_to_poolquery.
+   */
+  std::vector<PoolItem> matchByName( const PackageSpec & pkg, const std::list<std::string> & repos ) const;
+
   /**
    * Requests installation or update to the best of objects available in repos
    * according to specified arguments and options.
@@ -434,9 +448,14 @@ private:
   { _feedback.push_back( Feedback( id, reqpkg, selected, installed ) ); }
 
 private:
+  struct NameIndex;
+
   /** Various options to be applied to each requested package */
   Options _opts;
 
+  /** Case insensitive ident index for batched name lookups (or NULL). */
+  shared_ptr<NameIndex> _nameIndex;
+
   /** Requester command being executed.
    * \note This may be different from command given on command line.
    */
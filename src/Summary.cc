@@ -24,6 +24,7 @@
 #include "utils/misc.h"
 #include "Table.h"
 #include "Zypper.h"
+#include "output/XmlWriter.h"
 
 #include "Summary.h"
 
@@ -1433,7 +1434,7 @@ void Summary::dumpTo( std::ostream & out )
 
 // --------------------------------------------------------------------------
 
-void Summary::writeXmlResolvableList( std::ostream & out, const KindToResPairSet & resolvables )
+void Summary::writeXmlResolvableList( XmlWriter & xml, const KindToResPairSet & resolvables )
 {
   for_( it, resolvables.begin(), resolvables.end() )
   {
@@ -1442,27 +1443,27 @@ void Summary::writeXmlResolvableList( std::ostream & out, const KindToResPairSet
       ResObject::constPtr res( pairit->second );
       ResObject::constPtr rold( pairit->first );
 
-      out << "<solvable";
-      out << " type=\"" << res->kind() << "\"";
-      out << " name=\"" << res->name() << "\"";
-      out << " edition=\"" << res->edition() << "\"";
-      out << " arch=\"" << res->arch() << "\"";
+      xml << "<solvable";
+      xml << " type=\"" << res->kind() << "\"";
+      xml << " name=\"" << res->name() << "\"";
+      xml << " edition=\"" << res->edition() << "\"";
+      xml << " arch=\"" << res->arch() << "\"";
       if ( rold )
       {
-        out << " edition-old=\"" << rold->edition() << "\"";
-        out << " arch-old=\"" << rold->arch() << "\"";
+        xml << " edition-old=\"" << rold->edition() << "\"";
+        xml << " arch-old=\"" << rold->arch() << "\"";
       }
       {
 	const std::string & text( res->summary() );
 	if ( !text.empty() )
-	  out << " summary=\"" << xml::escape(text) << "\"";
+	  xml << XmlWriter::Attr( "summary", text );
       }
       {
 	const std::string & text( res->description() );
 	if ( !text.empty() )
-	  out << ">\n" << "<description>" << xml::escape( text ) << "</description>" << "</solvable>" << endl;
+	  xml << ">\n" << "<description>" << XmlWriter::Text( text ) << "</description>" << "</solvable>\n";
 	else
-	  out << "/>" << endl;
+	  xml << "/>\n";
       }
     }
   }
@@ -1472,66 +1473,67 @@ void Summary::writeXmlResolvableList( std::ostream & out, const KindToResPairSet
 
 void Summary::dumpAsXmlTo( std::ostream & out )
 {
-  out << "<install-summary";
-  out << " download-size=\"" << ((ByteCount::SizeType)_todownload) << "\"";
-  out << " space-usage-diff=\"" << ((ByteCount::SizeType)_inst_size_change) << "\"";
-  out << ">" << endl;
+  XmlWriter xml( out );
+  xml << "<install-summary";
+  xml << " download-size=\"" << ((ByteCount::SizeType)_todownload) << "\"";
+  xml << " space-usage-diff=\"" << ((ByteCount::SizeType)_inst_size_change) << "\"";
+  xml << ">\n";
 
   if ( !_toupgrade.empty() )
   {
-    out << "<to-upgrade>" << endl;
-    writeXmlResolvableList( out, _toupgrade );
-    out << "</to-upgrade>" << endl;
+    xml << "<to-upgrade>\n";
+    writeXmlResolvableList( xml, _toupgrade );
+    xml << "</to-upgrade>\n";
   }
 
   if ( !_todowngrade.empty() )
   {
-    out << "<to-downgrade>" << endl;
-    writeXmlResolvableList( out, _todowngrade );
-    out << "</to-downgrade>" << endl;
+    xml << "<to-downgrade>\n";
+    writeXmlResolvableList( xml, _todowngrade );
+    xml << "</to-downgrade>\n";
   }
 
   if ( !_toinstall.empty() )
   {
-    out << "<to-install>" << endl;
-    writeXmlResolvableList( out, _toinstall );
-    out << "</to-install>" << endl;
+    xml << "<to-install>\n";
+    writeXmlResolvableList( xml, _toinstall );
+    xml << "</to-install>\n";
   }
 
   if ( !_toreinstall.empty() )
   {
-    out << "<to-reinstall>" << endl;
-    writeXmlResolvableList( out, _toreinstall );
-    out << "</to-reinstall>" << endl;
+    xml << "<to-reinstall>\n";
+    writeXmlResolvableList( xml, _toreinstall );
+    xml << "</to-reinstall>\n";
   }
 
   if ( !_toremove.empty() )
   {
-    out << "<to-remove>" << endl;
-    writeXmlResolvableList( out, _toremove );
-    out << "</to-remove>" << endl;
+    xml << "<to-remove>\n";
+    writeXmlResolvableList( xml, _toremove );
+    xml << "</to-remove>\n";
   }
 
   if ( !_tochangearch.empty() )
   {
-    out << "<to-change-arch>" << endl;
-    writeXmlResolvableList( out, _tochangearch );
-    out << "</to-change-arch>" << endl;
+    xml << "<to-change-arch>\n";
+    writeXmlResolvableList( xml, _tochangearch );
+    xml << "</to-change-arch>\n";
   }
 
   if ( !_tochangevendor.empty() )
   {
-    out << "<to-change-vendor>" << endl;
-    writeXmlResolvableList( out, _tochangevendor );
-    out << "</to-change-vendor>" << endl;
+    xml << "<to-change-vendor>\n";
+    writeXmlResolvableList( xml, _tochangevendor );
+    xml << "</to-change-vendor>\n";
   }
 
   if ( _viewop & SHOW_UNSUPPORTED && !_unsupported.empty() )
   {
-    out << "<_unsupported>" << endl;
-    writeXmlResolvableList( out, _unsupported );
-    out << "</_unsupported>" << endl;
+    xml << "<_unsupported>\n";
+    writeXmlResolvableList( xml, _unsupported );
+    xml << "</_unsupported>\n";
   }
 
-  out << "</install-summary>" << endl;
+  xml << "</install-summary>\n";
 }
@@ -18,6 +18,7 @@
 #include <zypp/ResObject.h>
 #include <zypp/ResPool.h>
 
+class XmlWriter;
 
 class Summary : private base::NonCopyable
 {
@@ -107,7 +108,7 @@ private:
   bool writeResolvableList( std::ostream & out, const ResPairSet & resolvables, unsigned maxEntries_r, bool withKind_r = false )
   { return writeResolvableList( out, resolvables, ansi::Color::nocolor(), maxEntries_r, withKind_r ); }
 
-  void writeXmlResolvableList( std::ostream & out, const KindToResPairSet & resolvables );
+  void writeXmlResolvableList( XmlWriter & xml, const KindToResPairSet & resolvables );
 
   void collectInstalledRecommends( const ResObject::constPtr & obj );
 
@@ -10,11 +10,14 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <set>
 #include <sstream>
 #include <streambuf>
 #include <list>
 #include <map>
 #include <iterator>
+#include <memory>
 
 #include <unistd.h>
 #include <readline/history.h>
@@ -32,6 +35,7 @@
 #include <zypp/PoolQuery.h>
 #include <zypp/Locks.h>
 #include <zypp/Edition.h>
+#include <zypp/TmpPath.h>
 
 #include <zypp/target/rpm/RpmHeader.h> // for install <.rpmURI>
 
@@ -45,6 +49,7 @@
 #include "utils/misc.h"
 #include "utils/messages.h"
 #include "utils/getopt.h"
+#include "utils/AsyncLogWriter.h"
 #include "utils/misc.h"
 
 #include "repos.h"
@@ -53,8 +58,10 @@
 #include "misc.h"
 #include "locks.h"
 #include "search.h"
+#include "SimilarNames.h"
 #include "info.h"
 #include "ps.h"
+#include "complete.h"
 #include "download.h"
 #include "source-download.h"
 #include "configtest.h"
@@ -62,6 +69,7 @@
 
 #include "output/OutNormal.h"
 #include "output/OutXML.h"
+#include "output/OutJSON.h"
 
 using namespace zypp;
 
@@ -317,6 +325,7 @@ void print_main_help( Zypper & zypper )
     "\t\t\t\tDo not treat patches as interactive, which have\n"
     "\t\t\t\tthe rebootSuggested-flag set.\n"
     "\t--xmlout, -x\t\tSwitch to XML output.\n"
+    "\t--jsonout\t\tSwitch to JSON Lines output.\n"
     "\t--ignore-unknown, -i\tIgnore unknown packages.\n"
   );
 
@@ -344,7 +353,9 @@ void print_main_help( Zypper & zypper )
   );
 
   static std::string help_global_target_options = _("     Target Options:\n"
-    "\t--root, -R <dir>\tOperate on a different root directory.\n"
+    "\t--root, -R <dir>\tOperate on a different root directory. If given more than\n"
+    "\t\t\t\tonce, install, remove, update, patch, dist-upgrade and verify\n"
+    "\t\t\t\tare done in each root, loading the repositories only once.\n"
     "\t--disable-system-resolvables\n"
     "\t\t\t\tDo not read installed packages.\n"
   );
@@ -423,6 +434,7 @@ void print_main_help( Zypper & zypper )
     "\tdownload\t\tDownload rpms specified on the commandline to a local directory.\n"
     "\tsource-download\t\tDownload source rpms for all installed packages\n"
     "\t\t\t\tto a local directory.\n"
+    "\tcomplete\t\tPrint names starting with a prefix (shell completion).\n"
   );
 
   static std::string help_subcommands = _("     Subcommands:\n"
@@ -475,7 +487,21 @@ void print_command_help_hint( Zypper & zypper )
 int Zypper::defaultLoadSystem( LoadSystemFlags flags_r )
 {
   DBG << "FLAGS:" << flags_r << endl;
-  if ( ! flags_r.testFlag( NO_POOL ) )
+  if ( flags_r.testFlag( TARGET_ONLY ) )
+  {
+    // Repo data is irrelevant, so don't even look at the repos and services.
+    init_target( *this );
+    if ( exitCode() != ZYPPER_EXIT_OK )
+      return exitCode();
+
+    load_target_resolvables( *this );
+    if ( exitCode() != ZYPPER_EXIT_OK )
+      return exitCode();
+
+    // compute status of PPP
+    resolve(*this);
+  }
+  else if ( ! flags_r.testFlag( NO_POOL ) )
   {
     init_target( *this );
     if ( exitCode() != ZYPPER_EXIT_OK )
@@ -557,6 +583,7 @@ void Zypper::processGlobalOptions()
     {"no-remote",                  no_argument,       0,  0 },
     {"releasever",                 required_argument, 0,  0 },
     {"xmlout",                     no_argument,       0, 'x'},
+    {"jsonout",                    no_argument,       0,  0 },
     {"config",                     required_argument, 0, 'c'},
     {"userdata",                   required_argument, 0,  0 },
     {"ignore-unknown",             no_argument,       0, 'i'},
@@ -635,6 +662,14 @@ void Zypper::processGlobalOptions()
     _gopts.machine_readable = true;
     _gopts.no_abbrev = true;
   }
+  //// --jsonout
+  else if ( gopts.count("jsonout") )
+  {
+    _config.do_colors = false;	// no color in json mode!
+    _out_ptr = new OutJSON( verbosity );
+    _gopts.machine_readable = true;
+    _gopts.no_abbrev = true;
+  }
   else
   {
     OutNormal * p = new OutNormal( verbosity );
@@ -856,12 +891,21 @@ void Zypper::processGlobalOptions()
   {
     _gopts.root_dir = it->second.front();
     _gopts.changedRoot = true;
-    Pathname tmp( _gopts.root_dir );
-    if ( !tmp.absolute() )
+    for_( rit, it->second.begin(), it->second.end() )
     {
-      out().error(_("The path specified in the --root option must be absolute."));
-      setExitCode( ZYPPER_EXIT_ERR_INVALID_ARGS );
-      return;
+      Pathname tmp( *rit );
+      if ( !tmp.absolute() )
+      {
+	out().error(_("The path specified in the --root option must be absolute."));
+	setExitCode( ZYPPER_EXIT_ERR_INVALID_ARGS );
+	return;
+      }
+    }
+    if ( it->second.size() > 1 )
+    {
+      // multi-root mode: repos and caches are the ones of the first root
+      _gopts.root_dirs.assign( it->second.begin(), it->second.end() );
+      MIL << "Multi-root mode: " << _gopts.root_dirs.size() << " roots" << endl;
     }
 
     DBG << "root dir = " << _gopts.root_dir << endl;
@@ -1192,7 +1236,10 @@ void Zypper::safeDoCommand()
       ::copts = _copts;
     }
 
-    doCommand();
+    if ( _gopts.root_dirs.size() > 1 && ! runningHelp() )
+      doMultiRootCommand();
+    else
+      doCommand();
   }
   catch ( const AbortRequestException & ex )
   {
@@ -1223,6 +1270,128 @@ void Zypper::safeDoCommand()
   }
 }
 
+/// Multi-root mode: do the command in each of the \c --root dirs, one
+/// after the other. The repos are loaded only once, for the first root;
+/// for the others just the target is switched (\ref switch_target).
+void Zypper::doMultiRootCommand()
+{
+  switch ( command().toEnum() )
+  {
+    case ZypperCommand::INSTALL_e:
+    case ZypperCommand::REMOVE_e:
+    case ZypperCommand::UPDATE_e:
+    case ZypperCommand::PATCH_e:
+    case ZypperCommand::DIST_UPGRADE_e:
+    case ZypperCommand::VERIFY_e:
+    case ZypperCommand::INSTALL_NEW_RECOMMENDS_e:
+      break;
+
+    default:
+      out().error( str::Format(_("Command '%s' does not support more than one --root option.")) % command().asString() );
+      setExitCode( ZYPPER_EXIT_ERR_INVALID_ARGS );
+      return;
+  }
+
+  // Files given as option arguments must be read only once: standard
+  // input ('-') is at EOF for the second root. So --package-file lines
+  // are added to the arguments here, and an --issue-file read from stdin
+  // is saved to a temporary file used for all roots.
+  parsed_opts::iterator optit( _copts.find( "package-file" ) );
+  if ( optit != _copts.end() )
+  {
+    for ( const std::string & file : optit->second )
+    {
+      if ( ! read_list_file( file, _arguments ) )
+      {
+	setExitCode( ZYPPER_EXIT_ERR_INVALID_ARGS );
+	return;
+      }
+    }
+    _copts.erase( optit );
+  }
+  std::unique_ptr<filesystem::TmpFile> stdinCopy;
+  optit = _copts.find( "issue-file" );
+  if ( optit != _copts.end() && std::find( optit->second.begin(), optit->second.end(), "-" ) != optit->second.end() )
+  {
+    stdinCopy.reset( new filesystem::TmpFile );
+    {
+      std::ofstream copy( stdinCopy->path().c_str() );
+      copy << std::cin.rdbuf();
+    }
+    std::replace( optit->second.begin(), optit->second.end(), std::string( "-" ), stdinCopy->path().asString() );
+  }
+  ::copts = _copts;
+
+  // commands may modify their arguments and options
+  const ArgList arguments( _arguments );
+  const parsed_opts copts( _copts );
+
+  std::vector<int> results;
+  for_( it, _gopts.root_dirs.begin(), _gopts.root_dirs.end() )
+  {
+    out().info( str::Format(_("Root '%s':")) % *it );
+    _gopts.root_dir = *it;
+    _arguments = arguments;
+    _copts = copts;
+    ::copts = _copts;
+    setExitCode( ZYPPER_EXIT_OK );
+    _rdata.srcpkgs_to_install.clear();
+    _rdata.solve_before_commit = true;
+    _rdata.entered_commit = false;
+
+    try
+    {
+      if ( it != _gopts.root_dirs.begin() )
+	switch_target( *this, *it );
+      doCommand();
+    }
+    catch ( const AbortRequestException & ex )
+    {
+      ZYPP_CAUGHT( ex );
+      out().error( ex.asUserString() );
+      if ( ! exitCode() )
+	setExitCode( ZYPPER_EXIT_ERR_ZYPP );
+    }
+    catch ( const ExitRequestException & e )
+    {
+      ZYPP_CAUGHT( e );
+      MIL << "Caught exit request for root " << *it << ": exitCode " << exitCode() << endl;
+    }
+    MIL << "Root " << *it << " done: exitCode " << exitCode() << endl;
+    results.push_back( exitCode() );
+
+    if ( exitRequested() )	// signal
+      break;
+  }
+
+  // per root report; exit with the first failure, or else the first
+  // informational code (updates, reboot or restart needed)
+  int failure = ZYPPER_EXIT_OK;
+  int info = ZYPPER_EXIT_OK;
+  out().info( "" );
+  for ( unsigned i = 0; i < results.size(); ++i )
+  {
+    if ( results[i] == ZYPPER_EXIT_OK )
+      out().info( str::Format(_("Root '%s': done")) % _gopts.root_dirs[i] );
+    else if ( results[i] >= ZYPPER_EXIT_INF_UPDATE_NEEDED && results[i] <= ZYPPER_EXIT_INF_RESTART_NEEDED )
+    {
+      out().info( str::Format(_("Root '%s': done")) % _gopts.root_dirs[i] );
+      if ( info == ZYPPER_EXIT_OK )
+	info = results[i];
+    }
+    else
+    {
+      out().info( str::Format(_("Root '%s': failed (exit code %d)")) % _gopts.root_dirs[i] % results[i] );
+      if ( failure == ZYPPER_EXIT_OK )
+	failure = results[i];
+    }
+  }
+  int ret = ( failure != ZYPPER_EXIT_OK ? failure : info );
+  for ( unsigned i = results.size(); i < _gopts.root_dirs.size(); ++i )
+    out().info( str::Format(_("Root '%s': skipped")) % _gopts.root_dirs[i] );
+  setExitCode( ret );
+}
+
 // === command-specific options ===
 void Zypper::processCommandOptions()
 {
@@ -1315,6 +1484,7 @@ void Zypper::processCommandOptions()
       {"download-as-needed",        no_argument,       0,  0 },
       // rug compatibility - will mark all packages for installation (like 'in *')
       {"entire-catalog",            required_argument, 0,  0 },
+      {"package-file",              required_argument, 0,  0 },
       {"help",                      no_argument,       0, 'h'},
       {0, 0, 0, 0}
     };
@@ -1365,6 +1535,7 @@ void Zypper::processCommandOptions()
     ), "package, patch, pattern, product, srcpackage",
        "package",
        "only, in-advance, in-heaps, as-needed") )
+    .option( "--package-file <FILE>",	_("Read additional package arguments from FILE, one per line ('-' reads stdin).") )
     .option( "-y, --no-confirm",	_("Don't require user interaction. Alias for the --non-interactive global option.") )
     ;
     break;
@@ -1390,6 +1561,7 @@ void Zypper::processCommandOptions()
       {"details",		    no_argument,       0,  0 },
       // rug uses -N shorthand
       {"dry-run",    no_argument,       0, 'N'},
+      {"package-file", required_argument, 0, 0 },
       {"help",       no_argument,       0, 'h'},
       {0, 0, 0, 0}
     };
@@ -1420,6 +1592,7 @@ void Zypper::processCommandOptions()
       "-D, --dry-run               Test the removal, do not actually remove.\n"
       "    --details               Show the detailed installation summary.\n"
       ), "package, patch, pattern, product", "package") )
+    .option( "--package-file <FILE>",	_("Read additional package arguments from FILE, one per line ('-' reads stdin).") )
     .option( "-y, --no-confirm",	_("Don't require user interaction. Alias for the --non-interactive global option.") )
     ;
     break;
@@ -2078,6 +2251,7 @@ void Zypper::processCommandOptions()
       {"bugzilla",                  required_argument, 0, 'b'},
       {"bz",                        required_argument, 0,  0 },
       {"cve",                       required_argument, 0,  0 },
+      {"issue-file",                required_argument, 0,  0 },
       {"category",                  required_argument, 0, 'g'},
       {"severity",                  required_argument, 0,  0 },
       {"date",                      required_argument, 0,  0 },
@@ -2101,6 +2275,7 @@ void Zypper::processCommandOptions()
       "                            See man zypper for more details.\n"
       "-b, --bugzilla #            Install patch fixing the specified bugzilla issue.\n"
       "    --cve #                 Install patch fixing the specified CVE issue.\n"
+      "    --issue-file <file>     Install patches fixing the issues listed in the file.\n"
       "-g  --category <category>   Install only patches with this category.\n"
       "    --severity <severity>   Install only patches with this severity.\n"
       "    --date <YYYY-MM-DD>     Install only patches issued up to, but not including, the specified date\n"
@@ -2135,6 +2310,7 @@ void Zypper::processCommandOptions()
       {"severity",    required_argument, 0,  0 },
       {"date",        required_argument, 0,  0 },
       {"issues",      optional_argument, 0,  0 },
+      {"issue-file",  required_argument, 0,  0 },
       {"all",         no_argument,       0, 'a'},
       {"help", no_argument, 0, 'h'},
       {0, 0, 0, 0}
@@ -2149,6 +2325,7 @@ void Zypper::processCommandOptions()
       "-b, --bugzilla[=#]         List needed patches for Bugzilla issues.\n"
       "    --cve[=#]              List needed patches for CVE issues.\n"
       "    --issues[=string]      Look for issues matching the specified string.\n"
+      "    --issue-file <file>    List needed patches for the issues listed in the file.\n"
       "-a, --all                  List all patches, not only the needed ones.\n"
       "-g  --category <category>  List only patches with this category.\n"
       "    --severity <severity>  List only patches with this severity.\n"
@@ -2253,6 +2430,7 @@ void Zypper::processCommandOptions()
       // rug compatibility option, we have --sort-by-repo
       {"sort-by-catalog", no_argument, 0, 0},		// TRANSLATED into sort-by-repo
       {"sort-by-repo", no_argument, 0, 0},
+      {"limit", required_argument, 0, 0},
       // rug compatibility option, we have --repo
       {"catalog", required_argument, 0, 'c'},
       {"repo", required_argument, 0, 'r'},
@@ -2288,6 +2466,10 @@ void Zypper::processCommandOptions()
       "-r, --repo <alias|#|URI>   Search only in the specified repository.\n"
       "    --sort-by-name         Sort packages by name (default).\n"
       "    --sort-by-repo         Sort packages by repository.\n"
+      "    --limit <N>            Show only the <N> best matching packages, best\n"
+      "                           first: exact name matches, then names starting\n"
+      "                           with, then names containing a search string, then\n"
+      "                           summary matches.\n"
       "-s, --details              Show each available version in each repository\n"
       "                           on a separate line.\n"
       "-v, --verbose              Like --details, with additional information where the\n"
@@ -2797,6 +2979,29 @@ void Zypper::processCommandOptions()
   }
 
 
+  case ZypperCommand::COMPLETE_e:
+  {
+    static struct option options[] =
+    {
+      {"help",		no_argument,		0, 'h'},
+      {"type",		required_argument,	0, 't'},
+      {0, 0, 0, 0}
+    };
+    specific_options = options;
+    _command_help = CommandHelpFormater()
+    .synopsis(	// translators: command synopsis; do not translate the command 'name (abbreviations)' or '-option' names
+      _("complete [options] [prefix]")
+    )
+    .description(	// translators: command description
+      _("Print the names starting with prefix, one per line. Meant for shell completion: the names are looked up in an index kept in the repository cache, without loading the repositories or locking.") )
+    .optionSectionCommandOptions()
+    .option( "-t, --type <type>",	// translators: -t, --type <type>
+	     _("What to complete: 'installed' packages, 'repo' aliases, or available names of type 'package' (default), 'patch', 'pattern', 'product', or 'srcpackage'.") )
+    ;
+    break;
+  }
+
+
   case ZypperCommand::DOWNLOAD_e:
   {
     shared_ptr<DownloadOptions> myOpts( new DownloadOptions() );
@@ -3108,6 +3313,7 @@ void Zypper::doCommand()
   switch ( command().toEnum() )
   {
     case ZypperCommand::PS_e:
+    case ZypperCommand::COMPLETE_e:
     case ZypperCommand::SUBCOMMAND_e:
       // bnc#703598: Quick fix as few commands do not need a zypp lock
       break;
@@ -3830,6 +4036,16 @@ void Zypper::doCommand()
   {
     if (runningHelp()) { out().info(_command_help, Out::QUIET); return; }
 
+    // package arguments from file (e.g. image recipes)
+    for ( const auto & file : cOptValues( "package-file" ) )
+    {
+      if ( ! read_list_file( file.to_string(), _arguments ) )
+      {
+	setExitCode( ZYPPER_EXIT_ERR_INVALID_ARGS );
+	return;
+      }
+    }
+
     if ( _arguments.size() < 1 && !_copts.count("entire-catalog") )
     {
       out().error(
@@ -4192,11 +4408,54 @@ void Zypper::doCommand()
       }
     }
 
+    // show only the best <limit> matches (see SearchRanking)
+    unsigned limit = 0;
+    if ( copts.count("limit") )
+    {
+      const std::string & limitStr( copts["limit"].front() );
+      if ( limitStr.find_first_not_of( "0123456789" ) == std::string::npos )
+        str::strtonum( limitStr, limit );
+      if ( ! limit )
+      {
+        out().error( str::Format(_("Invalid limit '%s'. Use a positive integer number.")) % limitStr );
+        setExitCode( ZYPPER_EXIT_ERR_INVALID_ARGS );
+        return;
+      }
+    }
+
+    // Searching installed packages or products only (and not showing the repos
+    // they are available in), the repos are not needed at all. Pseudo installed
+    // kinds like patches and patterns need the repos to compute their status.
+    bool targetOnly = ( inst_notinst == true && copts.count("type") && !copts.count("repo") && !copts.count("catalog")
+                        && !_copts.count("details") && !_copts.count("verbose") );
+    if ( targetOnly )
+    {
+      for_( it, copts["type"].begin(), copts["type"].end() )
+      {
+        ResKind tkind( string_to_kind( *it ) );
+        if ( tkind != ResKind::package && tkind != ResKind::product )
+          targetOnly = false;
+      }
+      for_( it, _arguments.begin(), _arguments.end() )
+      {
+        if ( Capability::guessPackageSpec( *it ).detail().isVersioned() )
+          targetOnly = false;	// shows details
+      }
+    }
+
     initRepoManager();
 
-    init_repos( *this );
-    if ( exitCode() != ZYPPER_EXIT_OK )
-      return;
+    if ( targetOnly )
+    {
+      if ( defaultLoadSystem( TARGET_ONLY ) != ZYPPER_EXIT_OK )
+        return;
+    }
+    else
+    {
+      init_repos( *this );
+      if ( exitCode() != ZYPPER_EXIT_OK )
+        return;
+    }
 
     // add available repos to query
     if ( cOpts().count("repo") )
@@ -4212,6 +4471,18 @@ void Zypper::doCommand()
     }
 
     bool details = _copts.count("details") || _copts.count("verbose");
+    // the search strings, for ranking the matches
+    std::vector<std::string> rankTerms;
+    // summary and description search strings (see search_descriptions())
+    std::vector<std::string> descTerms;
+    // file list search strings (see search_file_list())
+    std::vector<std::pair<std::string,Capability>> fileTerms;
+    // whether the query gets more than these (an empty PoolQuery matches everything)
+    bool queryTerms = ( !_arguments.empty()
+                        && ( !copts.count("file-list") || copts.count("name")
+                             || copts.count("provides") || copts.count("requires")
+                             || copts.count("recommends") || copts.count("suggests")
+                             || copts.count("conflicts") || copts.count("obsoletes") ) );
     // add argument strings and attributes to query
     for_( it, _arguments.begin(), _arguments.end() )
     {
@@ -4232,6 +4503,7 @@ void Zypper::doCommand()
         name = name.substr( 1, name.size()-2 );
         query.setMatchRegex();
       }
+      rankTerms.push_back( name );
 
       sat::SolvAttr attr = sat::SolvAttr::name;
 
@@ -4244,7 +4516,7 @@ void Zypper::doCommand()
           // in case of path names also search in file list
           attr = sat::SolvAttr::filelist;
           query.setFilesMatchFullPath( true );
-          query.addDependency( attr , name, cap.detail().op(), cap.detail().ed(), Arch(cap.detail().arch()) );
+          fileTerms.push_back( std::make_pair( name, cap ) );
         }
       }
       if ( copts.count("requires") )
@@ -4276,7 +4548,7 @@ void Zypper::doCommand()
       {
         attr = sat::SolvAttr::filelist;
 	query.setFilesMatchFullPath( true );
-        query.addDependency( attr , name, cap.detail().op(), cap.detail().ed(), Arch(cap.detail().arch()) );
+        fileTerms.push_back( std::make_pair( name, cap ) );
       }
       if ( attr == sat::SolvAttr::name || copts.count("name") )
       {
@@ -4289,83 +4561,179 @@ void Zypper::doCommand()
         // all strings without an edition match to all editions
         query.setMatchExact();
       }
-      // for search in summary and description use addAttribute
+      // search in summary and description is added below
       if ( cOpts().count("search-descriptions") )
+        descTerms.push_back( name );
+    }
+
+    if ( ! targetOnly )
+    {
+      init_target( *this );
+
+      // now load resolvables:
+      load_resolvables( *this );
+      // needed to compute status of PPP
+      resolve( *this );
+    }
+
+    // Summary, description and file list are searched using the repos' search
+    // indexes and multiple threads (see search_descriptions()), unless match
+    // details are needed. Then PoolQuery scans them all.
+    bool verbose = _copts.count("verbose");
+    std::vector<sat::Solvable> indexMatches;
+    bool descIndexed = !descTerms.empty() && !verbose;
+    if ( descIndexed )
+      search_descriptions( *this, query, descTerms, indexMatches );
+    else if ( !descTerms.empty() )
+    {
+      for_( it, descTerms.begin(), descTerms.end() )
       {
-        query.addAttribute( sat::SolvAttr::summary, name );
-        query.addAttribute( sat::SolvAttr::description, name );
+        query.addAttribute( sat::SolvAttr::summary, *it );
+        query.addAttribute( sat::SolvAttr::description, *it );
       }
+      queryTerms = true;
     }
 
-    init_target( *this );
+    // paths with edition or arch are matched by PoolQuery
+    std::vector<std::string> filePaths;
+    bool filesIndexed = !fileTerms.empty() && !verbose;
+    for_( it, fileTerms.begin(), fileTerms.end() )
+    {
+      if ( it->second.detail().isVersioned() || !it->second.detail().arch().empty() )
+        filesIndexed = false;
+      filePaths.push_back( it->first );
+    }
+    if ( filesIndexed )
+      search_file_list( *this, query, filePaths, indexMatches );
+    else if ( !fileTerms.empty() )
+    {
+      for_( it, fileTerms.begin(), fileTerms.end() )
+      {
+        const CapDetail & detail( it->second.detail() );
+        query.addDependency( sat::SolvAttr::filelist, it->first, detail.op(), detail.ed(), Arch(detail.arch()) );
+      }
+      queryTerms = true;
+    }
 
-    // now load resolvables:
-    load_resolvables( *this );
-    // needed to compute status of PPP
-    resolve( *this );
+    // With the indexes, the matches are the union of the query's and the indexes'.
+    bool indexed = descIndexed || filesIndexed;
+    std::vector<sat::Solvable> matches;
+    std::vector<ui::Selectable::constPtr> matchingSelectables;
+    if ( indexed )
+    {
+      if ( queryTerms )
+        matches.assign( query.begin(), query.end() );
+      matches.insert( matches.end(), indexMatches.begin(), indexMatches.end() );
+      std::sort( matches.begin(), matches.end(), []( const sat::Solvable & lhs, const sat::Solvable & rhs ) { return lhs.id() < rhs.id(); } );
+      matches.erase( std::unique( matches.begin(), matches.end() ), matches.end() );
 
-    Table t;
-    t.lineStyle( Ascii );
+      std::set<ui::Selectable::constPtr> seen;
+      for_( it, matches.begin(), matches.end() )
+      {
+        ui::Selectable::constPtr sel( ui::Selectable::get( *it ) );
+        if ( seen.insert( sel ).second )
+          matchingSelectables.push_back( sel );
+      }
+    }
+
+    SearchResult result;
 
     try
     {
+      // With --limit, matches not ranked better than the ones kept so far are
+      // not even put into the result, and the scan stops once all kept matches
+      // are exact name matches.
+      SearchRanking ranking( query, rankTerms );
+      LimitedSearchResult limited( result, limit );
+
       if ( command() == ZypperCommand::RUG_PATCH_SEARCH )
       {
-        FillPatchesTable callback( t, inst_notinst );
-        invokeOnEach( query.poolItemBegin(), query.poolItemEnd(), callback );
+        FillPatchesTable callback( result, inst_notinst );
+        auto add = [&]( const PoolItem & pi ) {
+          limited.add( ranking( pi.satSolvable() ), [&]() { callback( pi ); } );
+          return !limited.full();
+        };
+        if ( indexed )
+        {
+          for_( it, matches.begin(), matches.end() )
+            if ( ! add( PoolItem( *it ) ) )
+              break;
+        }
+        else
+          invokeOnEach( query.poolItemBegin(), query.poolItemEnd(), add );
       }
       else if ( details )
       {
-        FillSearchTableSolvable callback( t, inst_notinst );
+        FillSearchTableSolvable callback( result, inst_notinst );
+        auto add = [&]( const ui::Selectable::constPtr & sel ) {
+          limited.add( ranking( sel ), [&]() { callback( sel ); } );
+          return !limited.full();
+        };
 	if ( _copts.count("verbose") )
 	{
 	  // Option 'verbose' shows where (e.g. in 'requires', 'name') the search has matched.
 	  // Info is available from PoolQuery::const_iterator.
 	  for_( it, query.begin(), query.end() )
-	    callback( it );
+	  {
+	    limited.add( ranking( *it ), [&]() { callback( it ); } );
+	    if ( limited.full() )
+	      break;
+	  }
 	}
+	else if ( indexed )
+	  invokeOnEach( matchingSelectables.begin(), matchingSelectables.end(), add );
 	else
-	  invokeOnEach( query.selectableBegin(), query.selectableEnd(), callback );
+	  invokeOnEach( query.selectableBegin(), query.selectableEnd(), add );
       }
       else
       {
-        FillSearchTableSelectable callback( t, inst_notinst );
-        invokeOnEach( query.selectableBegin(), query.selectableEnd(), callback );
+        FillSearchTableSelectable callback( result, inst_notinst );
+        auto add = [&]( const ui::Selectable::constPtr & sel ) {
+          limited.add( ranking( sel ), [&]() { callback( sel ); } );
+          return !limited.full();
+        };
+        if ( indexed )
+          invokeOnEach( matchingSelectables.begin(), matchingSelectables.end(), add );
+        else
+          invokeOnEach( query.selectableBegin(), query.selectableEnd(), add );
       }
+      limited.finish();
 
-      if ( t.empty() )
+      if ( result.empty() )
       {
         out().info(_("No packages found."), Out::QUIET );
         setExitCode( ZYPPER_EXIT_INF_CAP_NOT_FOUND );
+
+        // suggest similar names if plain names were searched
+        if ( !query.matchGlob() && !query.matchRegex() && !copts.count("file-list")
+             && !copts.count("provides") && !copts.count("requires")
+             && !copts.count("recommends") && !copts.count("suggests")
+             && !copts.count("conflicts") && !copts.count("obsoletes") )
+        {
+          ResKind hintKind( command() == ZypperCommand::RUG_PATCH_SEARCH ? ResKind::patch
+                            : copts.count("type") && copts["type"].size() == 1 ? kind : ResKind::package );
+          for_( it, rankTerms.begin(), rankTerms.end() )
+          {
+            std::string hint( SimilarNames::didYouMean( hintKind, *it ) );
+            if ( ! hint.empty() )
+              out().info( hint );
+          }
+        }
       }
       else
       {
-        cout << endl; //! \todo  out().separator()?
+        if ( ! out().typeJSON() )
+          cout << endl; //! \todo  out().separator()?
 
-        if ( command() == ZypperCommand::RUG_PATCH_SEARCH )
-        {
-          if ( copts.count("sort-by-repo") )
-            t.sort( 1 );
-          else
-            t.sort( 3 ); // sort by name
-        }
-        else if ( _copts.count("details") )
+        if ( ! limit )	// with --limit keep the ranking order
         {
-          if ( copts.count("sort-by-repo") )
-            t.sort( 5 );
+          if ( copts.count("sort-by-repo") && result.style() != SearchResult::SELECTABLES )
+            result.sortByRepo();
           else
-            t.sort( 1 ); // sort by name
-        }
-        else
-        {
-          // sort by name (can't sort by repo)
-          t.sort( 1 );
-          if ( !globalOpts().no_abbrev )
-            t.allowAbbrev( 2 );
+            result.sortByName();	// can't sort selectables by repo
         }
 
-	//cout << t; //! \todo out().table()?
-	out().searchResult( t );
+	out().searchResult( result );
       }
     }
     catch ( const Exception & e )
@@ -4435,6 +4803,16 @@ void Zypper::doCommand()
 
     initRepoManager();
 
+    if ( command() == ZypperCommand::PRODUCTS && copts.count("installed-only")
+         && _arguments.empty() && !copts.count("repo") && !copts.count("catalog") )
+    {
+      // installed products are listed as installed (see list_products);
+      // no need to look at the repos
+      if ( defaultLoadSystem( TARGET_ONLY ) == ZYPPER_EXIT_OK )
+        list_products( *this );
+      break;
+    }
+
     init_target( *this);
     init_repos( *this, _arguments );
     if ( exitCode() != ZYPPER_EXIT_OK )
@@ -4563,7 +4941,7 @@ void Zypper::doCommand()
     load_resolvables( *this );
     resolve( *this );
 
-    if ( copts.count("bugzilla") || copts.count("bz") || copts.count("cve") || copts.count("issues") )
+    if ( copts.count("bugzilla") || copts.count("bz") || copts.count("cve") || copts.count("issues") || copts.count("issue-file") )
       list_patches_by_issue( *this );
     else
       list_updates( *this, kinds, best_effort );
@@ -4596,7 +4974,7 @@ void Zypper::doCommand()
 
     if ( copts.count("updatestack-only") )
     {
-      for ( const char * opt : { "bugzilla", "bz", "cve" } )
+      for ( const char * opt : { "bugzilla", "bz", "cve", "issue-file" } )
       {
 	if ( copts.count( opt ) )
 	{
@@ -4685,8 +5063,8 @@ void Zypper::doCommand()
     resolve( *this ); // needed to compute status of PPP
 
 
-    // patch --bugzilla/--cve
-    if ( copts.count("bugzilla") || copts.count("bz") || copts.count("cve") )
+    // patch --bugzilla/--cve/--issue-file
+    if ( copts.count("bugzilla") || copts.count("bz") || copts.count("cve") || copts.count("issue-file") )
       mark_updates_by_issue( *this );
     // update without arguments
     else
@@ -5124,6 +5502,23 @@ void Zypper::doCommand()
   }
 
 
+  case ZypperCommand::COMPLETE_e:
+  {
+    if (runningHelp()) { out().info(_command_help, Out::QUIET); return; }
+
+    if ( _arguments.size() > 1 )
+    {
+      report_too_many_arguments( _command_help );
+      setExitCode( ZYPPER_EXIT_ERR_INVALID_ARGS );
+      return;
+    }
+
+    complete( *this, _copts.count( "type" ) ? _copts["type"].back() : "package",
+              _arguments.empty() ? std::string() : _arguments.front() );
+    break;
+  }
+
+
   case ZypperCommand::DOWNLOAD_e:
   {
     if (runningHelp()) { out().info(_command_help, Out::QUIET); return; }
@@ -5291,6 +5686,8 @@ void Zypper::cleanup()
     }
 
   _rm.reset();	// release any pending appdata trigger now.
+
+  AsyncLogWriter::flush();	// we may exit() right after being called
 }
 
 void rug_list_resolvables( Zypper & zypper )
@@ -99,6 +99,9 @@ struct GlobalOptions
   /** Whether to ignore remote (http, ...) repos */
   bool no_remote;
   std::string root_dir;
+  /** All \c --root dirs if given more than once (multi-root mode);
+   * \ref root_dir is the one currently operated on. */
+  std::vector<std::string> root_dirs;
   RepoManagerOptions rm_options;
   bool no_abbrev;
   bool terse;
@@ -248,7 +251,9 @@ public:
   {
     NO_TARGET		= (1 << 0),		//< don't load target to pool
     NO_REPOS		= (1 << 1),		//< don't load repos to pool
-    NO_POOL		= NO_TARGET | NO_REPOS	//< no pool at all
+    NO_POOL		= NO_TARGET | NO_REPOS,	//< no pool at all
+    TARGET_ONLY		= NO_REPOS | (1 << 2)	//< for queries about installed items only: load the
+						//< target, but neither refresh nor load any repo
   };
   ZYPP_DECLARE_FLAGS( LoadSystemFlags, LoadSystemBits );
 
@@ -299,6 +304,7 @@ private:
   void shellCleanup();
   void safeDoCommand();
   void doCommand();
+  void doMultiRootCommand();
 
   void setCommand( const ZypperCommand & command )	{ _command = command; }
   void setRunningShell( bool value = true )		{ _running_shell = value; }
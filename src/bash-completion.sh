@@ -24,23 +24,19 @@ _strip()
 
 _installed_packages() {
 	! [[ $cur =~ / ]] || return
-	grep -s --no-filename "^$cur" "/var/cache/zypp/solv/@System/solv.idx" | cut -f1
+	LC_ALL=POSIX $ZYPPER -q complete --type installed "$cur"
 }
 
-_available_solvables2() {
-	local lcur=$1
-	! [[ $cur =~ / ]] || return # for installing local packages
-	set +o noglob
-	grep -s --no-filename "^$lcur" /var/cache/zypp/solv/*/solv.idx |\
-		cut -f1 | sort --unique
-	set -o noglob
-}
 _available_solvables() {
-	_available_solvables2 "$1:$cur" | sed -e "s/^$1://"
+	! [[ $cur =~ / ]] || return # for installing local packages
+	LC_ALL=POSIX $ZYPPER -q complete --type "$1" "$cur"
 }
 _available_packages() {
 	[[ $cur ]] || return # this case is too slow with tenthousands of completions
-	_available_solvables2 $cur
+	_available_solvables package
+}
+_repo_aliases() {
+	LC_ALL=POSIX $ZYPPER -q complete --type repo "$cur"
 }
 
 _zypper() {
@@ -99,12 +95,7 @@ _zypper() {
 			return 0;
 		;;
 		"--repo" | "-r")
-			opts=(${opts[@]}$(echo; LC_ALL=POSIX $ZYPPER -q lr | \
-				sed -rn '/^[0-9]/{
-					s/^[0-9]+[[:blank:]]*\|[[:blank:]]*([^|]+).*/\1/
-					s/[[:blank:]]*$//
-					p
-				}'))
+			opts=(${opts[@]}$(echo; _repo_aliases ))
 			COMPREPLY=($(compgen -W "${opts[*]}" -- ${cur}))
 			_strip
 			eval $noglob
@@ -142,13 +133,7 @@ _zypper() {
 				opts=(${ZYPPER_CMDLIST[@]})
 			;;
 			removerepo | rr | modifyrepo | mr | renamerepo | nr | refresh | ref)
-				opts=(${opts[@]}$(echo; LC_ALL=POSIX $ZYPPER -q lr | \
-					sed -rn '/^[0-9]/{
-						s/^[0-9]+[[:blank:]]*\|[[:blank:]]*([^|]+).*/\1/
-						s/[[:blank:]]*$//
-						/^$/d
-						p
-					}'))
+				opts=(${opts[@]}$(echo; _repo_aliases ))
 			;;
 			addservice | as | modifyservice | ms | removeservice | rs)
 				opts=(${opts[@]}$(echo; LC_ALL=POSIX $ZYPPER -q ls | \
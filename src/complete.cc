@@ -0,0 +1,98 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include <zypp/base/Logger.h>
+#include <zypp/base/String.h>
+#include <zypp/RepoManager.h>
+#include <zypp/sat/Pool.h>
+
+#include "main.h"
+#include "Zypper.h"
+#include "SearchIndex.h"
+#include "utils/misc.h"
+#include "complete.h"
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  /** Fallback if there is no name index: libzypp's 'ident<TAB>...' lines. */
+  void solvIdxNames( const Pathname & dir_r, const std::string & prefix_r, std::vector<std::string> & result_r )
+  {
+    std::ifstream in( ( dir_r / "solv.idx" ).c_str() );
+    std::string line;
+    while ( std::getline( in, line ) )
+    {
+      if ( str::startsWith( line, prefix_r ) )
+	result_r.push_back( line.substr( 0, line.find( '\t' ) ) );
+    }
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+void complete( Zypper & zypper, const std::string & what, const std::string & prefix )
+{
+  std::vector<std::string> names;
+
+  if ( what == "repo" )
+  {
+    for_( it, zypper.repoManager().repoBegin(), zypper.repoManager().repoEnd() )
+    {
+      if ( str::startsWith( it->alias(), prefix ) )
+	names.push_back( it->alias() );
+    }
+  }
+  else
+  {
+    ResKind kind( what == "installed" ? ResKind::package : string_to_kind( what ) );
+    if ( kind == ResKind() )
+    {
+      zypper.out().error( str::Format(_("Unknown package type '%s'.")) % what );
+      zypper.setExitCode( ZYPPER_EXIT_ERR_INVALID_ARGS );
+      return;
+    }
+
+    // solvable idents are 'name' for packages, 'kind:name' else
+    std::string kindPrefix( kind == ResKind::package ? "" : kind.asString() + ":" );
+    const Pathname & cache( zypper.globalOpts().rm_options.repoSolvCachePath );
+
+    std::vector<Pathname> dirs;
+    dirs.push_back( cache / sat::Pool::systemRepoAlias() );
+    if ( what != "installed" )
+    {
+      for_( it, zypper.repoManager().repoBegin(), zypper.repoManager().repoEnd() )
+      {
+	if ( it->enabled() )
+	  dirs.push_back( cache / it->escaped_alias() );
+      }
+    }
+
+    std::vector<std::string> idents;
+    for_( it, dirs.begin(), dirs.end() )
+    {
+      if ( ! SearchIndex::completeNames( *it, kindPrefix + prefix, idents ) )
+      {
+	DBG << "No name index in " << *it << endl;
+	solvIdxNames( *it, kindPrefix + prefix, idents );
+      }
+    }
+
+    for_( it, idents.begin(), idents.end() )
+    {
+      if ( kindPrefix.empty() && it->find( ':' ) != std::string::npos )
+	continue;	// not a package
+      names.push_back( it->substr( kindPrefix.size() ) );
+    }
+  }
+
+  std::sort( names.begin(), names.end() );
+  names.erase( std::unique( names.begin(), names.end() ), names.end() );
+  for_( it, names.begin(), names.end() )
+    cout << *it << endl;
+}
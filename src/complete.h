@@ -0,0 +1,28 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#ifndef ZYPPER_COMPLETE_H
+#define ZYPPER_COMPLETE_H
+
+#include <string>
+class Zypper;
+
+/*
+      "complete [options] [prefix]\n"
+      "\n"
+      "Print the names starting with prefix, for shell completion.\n"
+*/
+
+/** Print the names of \a what_r (\c installed, \c repo, or a package type)
+ * starting with \a prefix_r, one per line.
+ *
+ * Names are taken from the name indexes in the solv cache (see
+ * \ref SearchIndex::completeNames), or libzypp's \c solv.idx if a repo
+ * has none. Nothing is loaded, and the ZYpp lock is not needed.
+ */
+void complete( Zypper & zypper_r, const std::string & what_r, const std::string & prefix_r );
+
+#endif // ZYPPER_COMPLETE_H
@@ -19,6 +19,7 @@
 #include "PackageArgs.h"
 #include "Table.h"
 #include "download.h"
+#include "ParallelDownload.h"
 #include "callbacks/media.h"
 
 ///////////////////////////////////////////////////////////////////
@@ -148,6 +149,25 @@ namespace
       _zypper.out().info( str::Str() << _("Not downloading anything...") << " (--dry-run)" );
     }
 
+    if ( !_options->_dryrun )
+    {
+      // Retrieve missing packages in parallel; the loop below then reports
+      // them as cached and retries those which failed.
+      ParallelDownload prefetch( _zypper );
+      for ( const auto & ent : collect )
+      {
+	for ( const auto & pi : ent.second )
+	{
+	  prefetch.add( pi );
+	  if ( !_options->_allmatches )
+	    break;	// first==best version only.
+	}
+      }
+      prefetch.run();
+      if ( _zypper.exitRequested() )
+	throw( Out::Error( ZYPPER_EXIT_ON_SIGNAL ) );
+    }
+
     // Prepare the package cache. Pass all items requiring download.
     target::CommitPackageCache packageCache( _zypper.globalOpts().root_dir );
     //packageCache.setCommitList( steps.begin(), steps.end() );
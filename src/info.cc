@@ -24,6 +24,7 @@
 #include "utils/text.h"
 #include "search.h"
 #include "update.h"
+#include "SimilarNames.h"
 
 #include "info.h"
 
@@ -177,6 +178,12 @@ void printInfo( Zypper & zypper, const ResKind & kind_r )
 	{ q.setMatchGlob(); }	// is Exact if no glob chars included in name
 	if ( ! q.empty() )
 	  logOtherKindMatches( q, kn._name );
+	else
+	{
+	  std::string hint( SimilarNames::didYouMean( kn._kind, kn._name ) );
+	  if ( ! hint.empty() )
+	    cout << hint << endl;
+	}
       }
       continue;
     }
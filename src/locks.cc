@@ -1,9 +1,14 @@
 #include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_map>
+#include <fnmatch.h>
 #include <boost/lexical_cast.hpp>
 
 #include <zypp/base/String.h>
 #include <zypp/base/Logger.h>
 #include <zypp/Locks.h>
+#include <zypp/sat/Pool.h>
 
 #include "output/Out.h"
 #include "main.h"
@@ -29,9 +34,9 @@ namespace
     return ret;
   }
 
-  inline std::string getLockDetails( const PoolQuery & q )
+  inline std::string getLockDetails( const std::vector<sat::Solvable> & matches )
   {
-    if ( q.empty() )
+    if ( matches.empty() )
       return "";
 
     PropertyTable p;
@@ -57,7 +62,7 @@ namespace
       };
       std::set<sat::Solvable,DoCompare> i;
       std::set<sat::Solvable,DoCompare> a;
-      for ( const auto & solv : q )
+      for ( const auto & solv : matches )
       { (solv.isSystem()?i:a).insert( solv ); }
 
       std::vector<std::string> names;
@@ -83,6 +88,212 @@ namespace
     return str::Str() << p;
   }
 
+  ///////////////////////////////////////////////////////////////////
+  /// \class LockMatcher
+  /// \brief Evaluate all locks in a single pass over the pool.
+  ///
+  /// Evaluating each lock's PoolQuery on its own scans the whole pool
+  /// once per lock. Locks which just match names (exact or glob, as
+  /// written by 'addlock') are compiled into a name index (globs by
+  /// their literal prefix) and matched together in one pass. Any other
+  /// lock is evaluated by its own PoolQuery.
+  ///////////////////////////////////////////////////////////////////
+  class LockMatcher
+  {
+  public:
+    typedef std::vector<sat::Solvable> Solvables;
+
+    LockMatcher( const Locks & locks_r )
+    : _matches( locks_r.size() )
+    {
+      unsigned idx = 0;
+      for ( const PoolQuery & q : locks_r )
+      {
+	if ( ! compile( idx, q ) )
+	{
+	  DBG << "Lock #" << idx+1 << " evaluated by PoolQuery" << endl;
+	  _matches[idx].assign( q.begin(), q.end() );
+	}
+	++idx;
+      }
+
+      if ( ! _rules.empty() )
+	scanPool();
+    }
+
+    /** Solvables matched by the \a idx_r-th lock. */
+    const Solvables & matches( unsigned idx_r ) const
+    { return _matches[idx_r]; }
+
+  private:
+    /** A compiled name (or glob) of a lock. */
+    struct Rule
+    {
+      unsigned _lock;
+      std::string _glob;	//< empty if matching exact
+      bool _nocase;
+      PoolQuery::Kinds _kinds;
+      PoolQuery::StrContainer _repos;
+    };
+
+    typedef std::unordered_map<std::string, std::vector<unsigned>> Index;
+
+    /** Compile \a q_r if it's a plain name lock. */
+    bool compile( unsigned idx_r, const PoolQuery & q_r )
+    {
+      const PoolQuery::AttrRawStrMap & attrs( q_r.attributes() );
+      if ( ! q_r.strings().empty()
+	|| attrs.size() != 1 || attrs.begin()->first != sat::SolvAttr::name
+	|| q_r.edition() != Edition::noedition
+	|| q_r.statusFilterFlags() != PoolQuery::ALL
+	|| ! ( q_r.matchExact() || q_r.matchGlob() ) )
+	return false;
+
+      // Dependency predicates are not accessible but serialized as 'complex:'
+      {
+	std::ostringstream str;
+	q_r.serialize( str );
+	if ( str.str().find( "complex:" ) != std::string::npos )
+	  return false;
+      }
+
+      for ( const std::string & name : attrs.begin()->second )
+      {
+	Rule rule;
+	rule._lock = idx_r;
+	rule._nocase = ! q_r.caseSensitive();
+	rule._kinds = q_r.kinds();
+	rule._repos = q_r.repos();
+
+	std::string key( rule._nocase ? str::toLower( name ) : name );
+	std::string::size_type wildcard = q_r.matchGlob() ? key.find_first_of( "*?[" ) : std::string::npos;
+	unsigned rno = _rules.size();
+	if ( wildcard == std::string::npos )
+	{
+	  ( rule._nocase ? _exactNocase : _exact )[key].push_back( rno );
+	}
+	else
+	{
+	  rule._glob = name;
+	  key.erase( wildcard );
+	  ( rule._nocase ? _prefixNocase : _prefix )[key].push_back( rno );
+	  _prefixLengths.insert( key.size() );
+	}
+	_rules.push_back( std::move(rule) );
+      }
+      return true;
+    }
+
+    void scanPool()
+    {
+      bool nocase = ! ( _exactNocase.empty() && _prefixNocase.empty() );
+      std::vector<unsigned> hits;
+
+      const sat::Pool & satpool( sat::Pool::instance() );
+      for_( it, satpool.solvablesBegin(), satpool.solvablesEnd() )
+      {
+	const sat::Solvable & solv( *it );
+	const std::string & name( solv.name() );
+	std::string lname;
+	if ( nocase )
+	  lname = str::toLower( name );
+
+	hits.clear();
+	lookup( _exact, name, hits );
+	lookup( _exactNocase, lname, hits );
+	for ( std::string::size_type len : _prefixLengths )
+	{
+	  if ( len > name.size() )
+	    break;
+	  lookup( _prefix, name.substr( 0, len ), hits );
+	  if ( nocase )
+	    lookup( _prefixNocase, lname.substr( 0, len ), hits );
+	}
+
+	unsigned lastLock = _matches.size();	// report each lock just once per solvable
+	std::sort( hits.begin(), hits.end() );
+	for ( unsigned rno : hits )
+	{
+	  const Rule & rule( _rules[rno] );
+	  if ( rule._lock == lastLock || ! matches( rule, solv, name ) )
+	    continue;
+	  _matches[rule._lock].push_back( solv );
+	  lastLock = rule._lock;
+	}
+      }
+    }
+
+    static void lookup( const Index & index_r, const std::string & key_r, std::vector<unsigned> & hits_r )
+    {
+      Index::const_iterator it( index_r.find( key_r ) );
+      if ( it != index_r.end() )
+	hits_r.insert( hits_r.end(), it->second.begin(), it->second.end() );
+    }
+
+    static bool matches( const Rule & rule_r, const sat::Solvable & solv_r, const std::string & name_r )
+    {
+      if ( ! rule_r._kinds.empty() && ! rule_r._kinds.count( solv_r.kind() ) )
+	return false;
+      if ( ! rule_r._repos.empty() && ! rule_r._repos.count( solv_r.repository().alias() ) )
+	return false;
+      if ( ! rule_r._glob.empty()
+	&& ::fnmatch( rule_r._glob.c_str(), name_r.c_str(), rule_r._nocase ? FNM_CASEFOLD : 0 ) != 0 )
+	return false;
+      return true;
+    }
+
+  private:
+    std::vector<Solvables> _matches;
+    std::vector<Rule> _rules;
+    Index _exact;
+    Index _exactNocase;
+    Index _prefix;
+    Index _prefixNocase;
+    std::set<std::string::size_type> _prefixLengths;
+  };
+
+  /** The names of the repos to restrict locks to (--repo). */
+  std::set<std::string> lock_repos( Zypper & zypper )
+  {
+    std::set<std::string> ret;
+    parsed_opts::const_iterator itr;
+    if ( (itr = copts.find("repo")) != copts.end() )
+    {
+      for_( it_repo, itr->second.begin(), itr->second.end() )
+      {
+	RepoInfo info;
+	if ( match_repo( zypper, *it_repo, &info ) )
+	  ret.insert( info.alias() );
+	else //TODO some error handling
+	  WAR << "unknown repository" << *it_repo << endl;
+      }
+    }
+    return ret;
+  }
+
+  /** The lock query for \a name as created by 'addlock' and removed by 'removelock'. */
+  PoolQuery lock_query( const std::string & name, const ResKindSet & kinds, const std::set<std::string> & repos )
+  {
+    PoolQuery q;
+    if ( kinds.empty() ) // derive it from the name
+    {
+      sat::Solvable::SplitIdent split( name );
+      q.addAttribute( sat::SolvAttr::name, split.name().asString() );
+      q.addKind( split.kind() );
+    }
+    else
+    {
+      q.addAttribute( sat::SolvAttr::name, name );
+      for_( itk, kinds.begin(), kinds.end() )
+	q.addKind( *itk );
+    }
+    q.setMatchGlob();
+    for ( const std::string & repo : repos )
+      q.addRepo( repo );
+    q.setCaseSensitive();
+    return q;
+  }
+
 } //namespace
 ///////////////////////////////////////////////////////////////////
 
@@ -107,6 +318,11 @@ void list_locks(Zypper & zypper)
     th << _("Type") << _("Repository");
     t << th;
 
+    // evaluate all locks at once
+    scoped_ptr<LockMatcher> matcher;
+    if ( withMatches )
+      matcher.reset( new LockMatcher( locks ) );
+
     unsigned i = 0;
     for ( const PoolQuery & q : locks )
     {
@@ -133,7 +349,7 @@ void list_locks(Zypper & zypper)
 
       // opt Matches
       if ( withMatches )
-	tr << q.size();
+	tr << matcher->matches( i-1 ).size();
 
       // type
       std::set<std::string> strings;
@@ -149,7 +365,7 @@ void list_locks(Zypper & zypper)
       // opt Solvables
       if ( withSolvables )
       {
-	tr.addDetail( getLockDetails( q ) );
+	tr.addDetail( getLockDetails( matcher->matches( i-1 ) ) );
       }
 
       t << tr;
@@ -185,40 +401,13 @@ void add_locks(Zypper & zypper, const Zypper::ArgList & args, const ResKindSet &
     locks.read(Pathname::assertprefix
         (zypper.globalOpts().root_dir, ZConfig::instance().locksFile()));
     Locks::size_type start = locks.size();
+    //TODO rug compatibility for more arguments with version restrict
+    const std::set<std::string> & repos( lock_repos( zypper ) );
     for_(it,args.begin(),args.end())
     {
-      PoolQuery q;
-      if ( kinds.empty() ) // derive it from the name
-      {
-        sat::Solvable::SplitIdent split( *it );
-        q.addAttribute( sat::SolvAttr::name, split.name().asString() );
-        q.addKind( split.kind() );
-      }
-      else
-      {
-        q.addAttribute(sat::SolvAttr::name, *it);
-        for_(itk, kinds.begin(), kinds.end()) {
-          q.addKind(*itk);
-        }
-      }
-      q.setMatchGlob();
-      parsed_opts::const_iterator itr;
-      //TODO rug compatibility for more arguments with version restrict
-      if ((itr = copts.find("repo")) != copts.end())
-      {
-        for_(it_repo,itr->second.begin(), itr->second.end())
-        {
-          RepoInfo info;
-          if( match_repo( zypper, *it_repo, &info))
-            q.addRepo(info.alias());
-          else //TODO some error handling
-            WAR << "unknown repository" << *it_repo << endl;
-        }
-      }
-      q.setCaseSensitive();
-
-      locks.addLock(q);
+      locks.addLock( lock_query( *it, kinds, repos ) );
     }
+    // all locks are written at once
     locks.save(Pathname::assertprefix
         (zypper.globalOpts().root_dir, ZConfig::instance().locksFile()));
     if ( start != Locks::instance().size() )
@@ -244,6 +433,7 @@ void remove_locks(Zypper & zypper, const Zypper::ArgList & args, const ResKindSe
     locks.read(Pathname::assertprefix
         (zypper.globalOpts().root_dir, ZConfig::instance().locksFile()));
     Locks::size_type start = locks.size();
+    const std::set<std::string> & repos( lock_repos( zypper ) );
     for_( args_it, args.begin(), args.end() )
     {
       Locks::const_iterator it = locks.begin();
@@ -258,42 +448,12 @@ void remove_locks(Zypper & zypper, const Zypper::ArgList & args, const ResKindSe
       }
       else //package name
       {
-        //TODO fill query in one method to have consistent add/remove
         //TODO what to do with repo and kinds?
-        PoolQuery q;
-	if ( kinds.empty() ) // derive it from the name
-	{
-	  // derive kind from the name: (rl should also support -t)
-	  sat::Solvable::SplitIdent split( *args_it );
-	  q.addAttribute( sat::SolvAttr::name, split.name().asString() );
-	  q.addKind( split.kind() );
-	}
-	else
-	{
-	  q.addAttribute(sat::SolvAttr::name, *args_it);
-	  for_(itk, kinds.begin(), kinds.end()) {
-	    q.addKind(*itk);
-	  }
-	}
-	q.setMatchGlob();
-        parsed_opts::const_iterator itr;
-        if ((itr = copts.find("repo")) != copts.end())
-        {
-          for_(it_repo,itr->second.begin(), itr->second.end())
-          {
-            RepoInfo info;
-            if( match_repo( zypper, *it_repo, &info))
-              q.addRepo(info.alias());
-            else //TODO some error handling
-              WAR << "unknown repository" << *it_repo << endl;
-          }
-        }
-        q.setCaseSensitive();
-
-        locks.removeLock(q);
+        locks.removeLock( lock_query( *args_it, kinds, repos ) );
       }
     }
 
+    // all locks are written at once
     locks.save(Pathname::assertprefix
         (zypper.globalOpts().root_dir, ZConfig::instance().locksFile()));
 
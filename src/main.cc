@@ -16,6 +16,7 @@
 #include "callbacks/job.h"
 #include "output/OutNormal.h"
 #include "utils/messages.h"
+#include "utils/AsyncLogWriter.h"
 
 
 void signal_handler( int sig )
@@ -71,6 +72,8 @@ int main( int argc, char **argv )
   if ( logfile == NULL )
     logfile = ZYPPER_LOG;
   base::LogControl::instance().logfile( logfile );
+  if ( std::string( logfile ) != "-" )
+    AsyncLogWriter::install();	// keep writing the log off the main thread
 
   MIL << "===== Hi, me zypper " VERSION << endl;
   dumpRange( MIL, argv, argv+argc, "===== ", "'", "' '", "'", " =====" ) << endl;
@@ -0,0 +1,45 @@
+#include <iostream>
+
+#include "JsonObject.h"
+
+void JsonObject::writeLine( std::ostream & out_r ) const
+{
+  out_r.write( _json.data(), _json.size() );
+  out_r.write( "}\n", 2 );
+}
+
+void JsonObject::quote( std::string & buf_r, boost::string_ref text_r )
+{
+  static const char hex[] = "0123456789abcdef";
+
+  buf_r += '"';
+  const char * p = text_r.data();
+  const char * end = p + text_r.size();
+  const char * clean = p;	// start of the pending clean run
+  for ( ; p != end; ++p )
+  {
+    unsigned char ch = *p;
+    if ( ch >= 0x20 && ch != '"' && ch != '\\' )
+      continue;
+
+    buf_r.append( clean, p - clean );
+    clean = p + 1;
+    switch ( ch )
+    {
+      case '"':		buf_r += "\\\"";	break;
+      case '\\':	buf_r += "\\\\";	break;
+      case '\n':	buf_r += "\\n";		break;
+      case '\t':	buf_r += "\\t";		break;
+      case '\r':	buf_r += "\\r";		break;
+      case '\b':	buf_r += "\\b";		break;
+      case '\f':	buf_r += "\\f";		break;
+      default:
+	buf_r += "\\u00";
+	buf_r += hex[ch >> 4];
+	buf_r += hex[ch & 0xf];
+	break;
+    }
+  }
+  buf_r.append( clean, end - clean );
+  buf_r += '"';
+}
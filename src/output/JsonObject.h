@@ -0,0 +1,76 @@
+#ifndef JSONOBJECT_H_
+#define JSONOBJECT_H_
+
+#include <iosfwd>
+#include <string>
+#include <type_traits>
+
+#include <boost/utility/string_ref.hpp>
+
+///////////////////////////////////////////////////////////////////
+/// \class JsonObject
+/// \brief Compact JSON object built member by member.
+///
+/// Strings are expected to be UTF-8 and are escaped as required by
+/// RFC 8259 (quotation mark, backslash and control characters only).
+/// \ref writeLine writes the object as one line of a JSON Lines stream.
+///
+/// \code
+///   JsonObject().add( "type", "message" ).add( "level", "info" ).add( "text", msg ).writeLine( cout );
+///   // {"type":"message","level":"info","text":"..."}
+/// \endcode
+///////////////////////////////////////////////////////////////////
+class JsonObject
+{
+public:
+  JsonObject()
+  : _json( 1, '{' )
+  {}
+
+  /** String member. */
+  JsonObject & add( boost::string_ref key_r, boost::string_ref value_r )
+  { key( key_r ); quote( _json, value_r ); return *this; }
+
+  JsonObject & add( boost::string_ref key_r, const char * value_r )
+  { return add( key_r, boost::string_ref( value_r ) ); }
+
+  JsonObject & add( boost::string_ref key_r, const std::string & value_r )
+  { return add( key_r, boost::string_ref( value_r ) ); }
+
+  /** Boolean member. */
+  JsonObject & add( boost::string_ref key_r, bool value_r )
+  { key( key_r ); _json += ( value_r ? "true" : "false" ); return *this; }
+
+  /** Number member. */
+  template <class Tp>
+  typename std::enable_if<std::is_integral<Tp>::value && !std::is_same<Tp,bool>::value, JsonObject &>::type add( boost::string_ref key_r, Tp value_r )
+  { key( key_r ); _json += std::to_string( value_r ); return *this; }
+
+  /** Member whose value is already JSON (a nested object or array). */
+  JsonObject & addRaw( boost::string_ref key_r, boost::string_ref json_r )
+  { key( key_r ); _json.append( json_r.data(), json_r.size() ); return *this; }
+
+  /** The object as JSON text. */
+  std::string asString() const
+  { return _json + '}'; }
+
+  /** Write the object followed by a newline to \a out_r. */
+  void writeLine( std::ostream & out_r ) const;
+
+public:
+  /** Append \a text_r as a quoted and escaped JSON string to \a buf_r. */
+  static void quote( std::string & buf_r, boost::string_ref text_r );
+
+private:
+  void key( boost::string_ref key_r )
+  {
+    if ( _json.size() > 1 )
+      _json += ',';
+    quote( _json, key_r );
+    _json += ':';
+  }
+
+  std::string _json;
+};
+
+#endif /*JSONOBJECT_H_*/
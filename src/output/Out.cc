@@ -8,8 +8,11 @@
 #include "Out.h"
 #include "Table.h"
 #include "Utf8.h"
+#include "OutJSON.h"
+#include "JsonObject.h"
 
 #include "Zypper.h"
+#include "SearchResult.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 //	class TermLine
@@ -112,9 +115,22 @@ std::string Out::zyppExceptionReport(const Exception & e)
   return s.str();
 }
 
-void Out::searchResult( const Table & table_r )
+void Out::searchResult( const SearchResult & result_r )
 {
-  std::cout << table_r;
+  Table t;
+  t.lineStyle( Ascii );
+  result_r.fillTable( t );
+  std::cout << t;
+}
+
+void Out::jsonListElement( const std::string & id_r, const std::string & text_r )
+{
+  JsonObject line;
+  line.add( "type", "list" );
+  if ( ! id_r.empty() )
+    line.add( "id", id_r );
+  line.add( "text", text_r );
+  OutJSON::writeRow( line );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -25,6 +25,7 @@
 using namespace zypp;
 
 class Table;
+class SearchResult;
 class Zypper;
 
 #define OSD ColorStream( std::cout, ColorContext::OSDEBUG )
@@ -275,7 +276,8 @@ public:
   enum TypeBit
   {
     TYPE_NORMAL = 0x01<<0,	///< plain text output
-    TYPE_XML    = 0x01<<1	///< xml output
+    TYPE_XML    = 0x01<<1,	///< xml output
+    TYPE_JSON   = 0x01<<2	///< json lines output
   };
   ZYPP_DECLARE_FLAGS(Type,TypeBit);
 
@@ -399,6 +401,12 @@ public:
 	for_( it, begin_r, end_r ) mlist << ( *it );
       }
       break;
+      case TYPE_JSON:
+      {
+	ListFormater_ formater( std::forward<ListFormater_>(formater_r) );
+	for_( it, begin_r, end_r ) jsonListElement( "", formater( *it ) );
+      }
+      break;
     }
   }
 
@@ -422,6 +430,12 @@ public:
   template <class Container_, class ListFormater_ = out::ListFormater>
   void list( const std::string & nodeName_r, const std::string & title_r, const Container_ & container_r, ListFormater_ && formater_r = ListFormater_() )
   {
+    if ( typeJSON() )
+    {
+      ListFormater_ formater( std::forward<ListFormater_>(formater_r) );
+      for_( it, container_r.begin(), container_r.end() ) jsonListElement( nodeName_r, formater( *it ) );
+      return;
+    }
     TitleNode guard( XmlNode( *this, nodeName_r, XmlNode::Attr( "size", str::numstring( container_r.size() ) ) ),
 		     str::FormatNAC( title_r ) % container_r.size() );
     list( container_r, std::forward<ListFormater_>(formater_r) );
@@ -609,13 +623,11 @@ public:
   /**
    * Print out a search result.
    *
-   * Default implementation prints \a table_r on \c stdout.
-   *
-   * \param table_r Table containing the search result.
+   * Default implementation prints \a result_r as a \ref Table on \c stdout.
    *
-   * \todo Using a more generic format than a Table is desired.
+   * \param result_r The rows found by the search.
    */
-  virtual void searchResult( const Table & table_r );
+  virtual void searchResult( const SearchResult & result_r );
 
   /**
    * Prompt the user for a decision.
@@ -680,6 +692,8 @@ public:
   bool typeNORMAL() const { return type( TYPE_NORMAL ); }
   /** \overload test for TPE_XML */
   bool typeXML() const { return type( TYPE_XML ); }
+  /** \overload test for TYPE_JSON */
+  bool typeJSON() const { return type( TYPE_JSON ); }
 
   /** Terminal width or 150 if unlimited.
    * If a \a desired_r value is given, return the
@@ -717,6 +731,10 @@ protected:
    */
   virtual std::string zyppExceptionReport(const Exception & e);
 
+private:
+  /** JSON: write a \c list line for an element of list \a id_r (may be empty). */
+  void jsonListElement( const std::string & id_r, const std::string & text_r );
+
 private:
   Verbosity _verbosity;
   const TypeBit _type;
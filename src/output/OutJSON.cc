@@ -0,0 +1,237 @@
+#include <iostream>
+#include <sstream>
+
+#include <zypp/base/String.h>
+#include <zypp/Patch.h>
+#include <zypp/PoolItem.h>
+
+#include "OutJSON.h"
+#include "JsonObject.h"
+#include "SearchResult.h"
+
+using std::cout;
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  inline const char * statusString( SearchResult::Status status_r )
+  {
+    switch ( status_r )
+    {
+      case SearchResult::INSTALLED:	return "installed";
+      case SearchResult::OTHER_VERSION:	return "other-version";
+      case SearchResult::NOT_INSTALLED:	break;
+    }
+    return "not-installed";
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+OutJSON::OutJSON( Verbosity verbosity_r )
+: Out( TYPE_JSON, verbosity_r )
+{
+  writeEvent( JsonObject().add( "type", "stream" ).add( "version", "1.0" ) );
+}
+
+OutJSON::~OutJSON()
+{
+  cout.flush();
+}
+
+bool OutJSON::mine( Type type )
+{
+  if ( type & Out::TYPE_JSON )
+    return true;
+  return false;
+}
+
+bool OutJSON::infoWarningFilter( Verbosity verbosity_r, Type mask )
+{
+  if ( !mine(mask) )
+    return true;
+  if ( verbosity() < verbosity_r )
+    return true;
+  return false;
+}
+
+void OutJSON::writeRow( const JsonObject & line_r )
+{
+  line_r.writeLine( cout );
+}
+
+void OutJSON::writeEvent( const JsonObject & line_r )
+{
+  line_r.writeLine( cout );
+  cout.flush();
+}
+
+void OutJSON::info( const std::string & msg, Verbosity verbosity_r, Type mask )
+{
+  if ( infoWarningFilter( verbosity_r, mask ) || msg.empty() )	// empty ones are just separators
+    return;
+
+  writeEvent( JsonObject().add( "type", "message" ).add( "level", "info" ).add( "text", msg ) );
+}
+
+void OutJSON::warning( const std::string & msg, Verbosity verbosity_r, Type mask )
+{
+  if ( infoWarningFilter( verbosity_r, mask ) )
+    return;
+
+  writeEvent( JsonObject().add( "type", "message" ).add( "level", "warning" ).add( "text", msg ) );
+}
+
+void OutJSON::error( const std::string & problem_desc, const std::string & hint )
+{
+  JsonObject line;
+  line.add( "type", "message" ).add( "level", "error" ).add( "text", problem_desc );
+  if ( !hint.empty() )
+    line.add( "hint", hint );
+  writeEvent( line );
+}
+
+void OutJSON::error( const Exception & e, const std::string & problem_desc, const std::string & hint )
+{
+  JsonObject line;
+  line.add( "type", "message" ).add( "level", "error" ).add( "text", problem_desc )
+      .add( "cause", zyppExceptionReport( e ) );
+  if ( !hint.empty() )
+    line.add( "hint", hint );
+  writeEvent( line );
+}
+
+void OutJSON::progressStart( const std::string & id, const std::string & label, bool has_range )
+{
+  if ( progressFilter() )
+    return;
+
+  JsonObject line;
+  line.add( "type", "progress" ).add( "id", id ).add( "name", label );
+  if ( has_range )
+    line.add( "value", 0 );
+  writeEvent( line );
+}
+
+void OutJSON::progress( const std::string & id, const std::string& label, int value )
+{
+  if ( progressFilter() )
+    return;
+
+  JsonObject line;
+  line.add( "type", "progress" ).add( "id", id ).add( "name", label );
+  // missing value means 'is-alive' notification
+  if ( value >= 0 )
+    line.add( "value", value );
+  writeEvent( line );
+}
+
+void OutJSON::progressEnd( const std::string & id, const std::string& label, bool error )
+{
+  if ( progressFilter() )
+    return;
+
+  writeEvent( JsonObject().add( "type", "progress" ).add( "id", id ).add( "name", label )
+	      .add( "done", true ).add( "error", error ) );
+}
+
+void OutJSON::dwnldProgressStart( const Url & uri )
+{
+  writeEvent( JsonObject().add( "type", "download" ).add( "url", uri.asString() )
+	      .add( "percent", -1 ).add( "rate", -1 ) );
+}
+
+void OutJSON::dwnldProgress( const Url & uri, int value, long rate )
+{
+  writeEvent( JsonObject().add( "type", "download" ).add( "url", uri.asString() )
+	      .add( "percent", value ).add( "rate", rate ) );
+}
+
+void OutJSON::dwnldProgressEnd( const Url & uri, long rate, bool error )
+{
+  writeEvent( JsonObject().add( "type", "download" ).add( "url", uri.asString() )
+	      .add( "rate", rate ).add( "done", true ).add( "error", error ) );
+}
+
+void OutJSON::searchResult( const SearchResult & result_r )
+{
+  const SearchResult::container & rows( result_r.rows() );
+  for_( it, rows.begin(), rows.end() )
+  {
+    PoolItem pi( it->_solvable );
+    JsonObject line;
+    line.add( "type", "solvable" )
+        .add( "status", statusString( it->_status ) )
+        .add( "locked", it->_locked )
+        .add( "kind", pi.kind().asString() )
+        .add( "name", pi.name() );
+
+    switch ( result_r.style() )
+    {
+      case SearchResult::SELECTABLES:
+	line.add( "summary", pi.summary() );
+	break;
+
+      case SearchResult::SOLVABLES:
+	line.add( "edition", pi.edition().asString() )
+	    .add( "arch", pi.arch().asString() )
+	    .add( "repository", pi.repository().alias() );
+	break;
+
+      case SearchResult::PATCHES:
+      {
+	Patch::constPtr patch( asKind<Patch>( pi.resolvable() ) );
+	line.add( "edition", pi.edition().asString() )
+	    .add( "category", patch->category() )
+	    .add( "severity", patch->severity() )
+	    .add( "repository", pi.repository().alias() );
+	break;
+      }
+    }
+
+    if ( ! it->_details.empty() )
+    {
+      std::string matches( 1, '[' );
+      for_( dit, it->_details.begin(), it->_details.end() )
+      {
+	if ( dit != it->_details.begin() )
+	  matches += ',';
+	JsonObject::quote( matches, *dit );
+      }
+      matches += ']';
+      line.addRaw( "matches", matches );
+    }
+    writeRow( line );
+  }
+  cout.flush();
+}
+
+void OutJSON::prompt( PromptId id, const std::string & prompt, const PromptOptions & poptions, const std::string & startdesc )
+{
+  std::string options( 1, '[' );
+  unsigned i = 0;
+  for ( PromptOptions::StrVector::const_iterator it = poptions.options().begin(); it != poptions.options().end(); ++it, ++i )
+  {
+    if ( poptions.isDisabled( i ) )
+      continue;
+    JsonObject option;
+    option.add( "value", *it ).add( "desc", poptions.optionHelp( i ) );
+    if ( poptions.defaultOpt() == i )
+      option.add( "default", true );
+    if ( options.size() > 1 )
+      options += ',';
+    options += option.asString();
+  }
+  options += ']';
+
+  JsonObject line;
+  line.add( "type", "prompt" ).add( "id", int(id) );
+  if ( !startdesc.empty() )
+    line.add( "description", startdesc );
+  line.add( "text", prompt ).addRaw( "options", options );
+  writeEvent( line );
+}
+
+void OutJSON::promptHelp( const PromptOptions & poptions )
+{
+  // nothing to do here
+}
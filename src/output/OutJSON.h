@@ -0,0 +1,73 @@
+#ifndef OUTJSON_H_
+#define OUTJSON_H_
+
+#include "Out.h"
+
+class JsonObject;
+
+///////////////////////////////////////////////////////////////////
+/// \class OutJSON
+/// \brief JSON Lines output: one compact JSON object per line.
+///
+/// Every message, progress and download event, prompt and result row
+/// is written as a single line as soon as it happens. The \c "type"
+/// member tells what the line is about. The line types and their members
+/// are documented in the manual page (--jsonout).
+///////////////////////////////////////////////////////////////////
+class OutJSON : public Out
+{
+public:
+  OutJSON(Verbosity verbosity = NORMAL);
+  virtual ~OutJSON();
+
+public:
+  virtual void info(const std::string & msg, Verbosity verbosity = NORMAL, Type mask = TYPE_ALL);
+  virtual void warning(const std::string & msg, Verbosity verbosity = NORMAL, Type mask = TYPE_ALL);
+  virtual void error(const std::string & problem_desc, const std::string & hint = "");
+  virtual void error(const Exception & e,
+             const std::string & problem_desc,
+             const std::string & hint = "");
+
+  // progress
+  virtual void progressStart(const std::string & id,
+                             const std::string & label,
+                             bool is_tick = false);
+  virtual void progress(const std::string & id,
+                        const std::string & label,
+                        int value = -1);
+  virtual void progressEnd(const std::string & id,
+                           const std::string & label,
+                           bool error);
+
+  // progress with download rate
+  virtual void dwnldProgressStart(const Url & uri);
+  virtual void dwnldProgress(const Url & uri,
+                             int value = -1,
+                             long rate = -1);
+  virtual void dwnldProgressEnd(const Url & uri,
+                                long rate = -1,
+                                bool error = false);
+
+  virtual void searchResult( const SearchResult & result_r );
+
+  virtual void prompt(PromptId id,
+                      const std::string & prompt,
+                      const PromptOptions & poptions,
+                      const std::string & startdesc = "");
+
+  virtual void promptHelp(const PromptOptions & poptions);
+
+public:
+  /** Write \a line_r (a result row) to \c stdout. Not flushed, as more rows are likely to follow. */
+  static void writeRow( const JsonObject & line_r );
+
+protected:
+  virtual bool mine(Type type);
+
+private:
+  bool infoWarningFilter(Verbosity verbosity, Type mask);
+  /** Write \a line_r (an event) to \c stdout and flush. */
+  void writeEvent(const JsonObject & line_r);
+};
+
+#endif /*OUTJSON_H_*/
@@ -31,7 +31,7 @@ OutNormal::OutNormal( Verbosity verbosity_r )
 , _use_colors( false )
 , _isatty( isatty(STDOUT_FILENO) )
 , _newline( true )
-, _oneup( false )
+, _progress( cout )
 {}
 
 OutNormal::~OutNormal()
@@ -55,7 +55,10 @@ void OutNormal::info( const std::string & msg_r, Verbosity verbosity_r, Type mas
     return;
 
   if ( !_newline )
+  {
     cout << endl;
+    _progress.detach();
+  }
 
   ColorString msg( msg_r, ColorContext::MSG_STATUS );
   if ( verbosity_r == Out::QUIET )
@@ -76,7 +79,10 @@ void OutNormal::warning( const std::string & msg, Verbosity verbosity_r, Type ma
     return;
 
   if ( !_newline )
+  {
     cout << endl;
+    _progress.detach();
+  }
 
   cout << ( ColorContext::MSG_WARNING << _("Warning: ") ) << msg << endl;
   _newline = true;
@@ -85,7 +91,10 @@ void OutNormal::warning( const std::string & msg, Verbosity verbosity_r, Type ma
 void OutNormal::error( const std::string & problem_desc, const std::string & hint )
 {
   if ( !_newline )
+  {
     cout << endl;
+    _progress.detach();
+  }
 
   cerr << ( ColorContext::MSG_ERROR << problem_desc );
   if ( !hint.empty() && verbosity() > Out::QUIET )
@@ -99,7 +108,10 @@ void OutNormal::error( const std::string & problem_desc, const std::string & hin
 void OutNormal::error( const Exception & e, const std::string & problem_desc, const std::string & hint )
 {
   if ( !_newline )
+  {
     cout << endl;
+    _progress.detach();
+  }
 
   // problem and cause
   cerr << ( ColorContext::MSG_ERROR << problem_desc << endl << zyppExceptionReport(e) ) << endl;
@@ -113,12 +125,15 @@ void OutNormal::error( const Exception & e, const std::string & problem_desc, co
 
 // ----------------------------------------------------------------------------
 
-void OutNormal::displayProgress ( const std::string & s, int percent )
+void OutNormal::displayProgress ( const std::string & id, const std::string & s, int percent )
 {
   static AliveCursor cursor;
 
   if ( _isatty )
   {
+    if ( ! _progress.due( id ) )
+      return;	// not before the next frame
+
     TermLine outstr( TermLine::SF_CRUSH | TermLine::SF_EXPAND, '-' );
     outstr.lhs << s << ' ';
 
@@ -130,41 +145,63 @@ void OutNormal::displayProgress ( const std::string & s, int percent )
     ++cursor;
     outstr.rhs << '[' << cursor.current() << ']';
 
-    if ( _oneup )
-      cout << CLEARLN << CURSORUP(1);
-    cout << CLEARLN;
-
-    std::string outline( outstr.get( termwidth() ) );
-    cout << outline << std::flush;
-    // no _oneup if CRUSHed // _oneup = ( outline.length() > termwidth() );
+    // CRUSHed to termwidth, so each line takes exactly one screen line
+    _progress.update( id, outstr.get( termwidth() ) );
   }
   else
-    cout << '.' << std::flush;
+    displayDot();
 }
 
 // ----------------------------------------------------------------------------
 
-void OutNormal::displayTick( const std::string & s )
+void OutNormal::displayTick( const std::string & id, const std::string & s )
 {
   static AliveCursor cursor;
 
   if ( _isatty )
   {
+    if ( ! _progress.due( id ) )
+      return;	// not before the next frame
+
     TermLine outstr( TermLine::SF_CRUSH | TermLine::SF_EXPAND, '-' );
     ++cursor;
     outstr.lhs << s << ' ';
     outstr.rhs << '[' << cursor.current() << ']';
 
-    if( _oneup )
-      cout << CLEARLN << CURSORUP(1);
-    cout << CLEARLN;
+    _progress.update( id, outstr.get( termwidth() ) );
+  }
+  else
+    displayDot();
+}
+
+// ----------------------------------------------------------------------------
 
-    std::string outline( outstr.get( termwidth() ) );
-    cout << outline << std::flush;
-    // no _oneup if CRUSHed // _oneup = ( outline.length() > termwidth() );
+void OutNormal::displayDot()
+{
+  // Not a terminal (log file, pipe): one dot per second is enough to
+  // tell it's still alive, no matter how often the callbacks come.
+  ProgressRenderer::Clock::time_point now( ProgressRenderer::Clock::now() );
+  if ( now - _lastDot < std::chrono::seconds( 1 ) )
+    return;
+  _lastDot = now;
+  cout << '.' << std::flush;
+}
+
+// ----------------------------------------------------------------------------
+
+void OutNormal::finishProgress( const std::string & id, const std::string & outline, bool error )
+{
+  if ( _isatty )
+  {
+    if ( !error && _use_colors )
+      _progress.finish( id, ColorString( outline, ColorContext::MSG_STATUS ).str() );
+    else
+      _progress.finish( id, outline );
   }
   else
-    cout << '.' << std::flush;
+    cout << outline << endl << std::flush;
+  // lines of concurrent progresses are still on screen
+  _newline = _progress.empty();
 }
 
 // ----------------------------------------------------------------------------
@@ -175,12 +212,15 @@ void OutNormal::progressStart( const std::string & id, const std::string & label
     return;
 
   if ( !_isatty )
+  {
     cout << label << " [";
+    _lastDot = ProgressRenderer::Clock::time_point();
+  }
 
   if ( is_tick )
-    displayTick( label );
+    displayTick( id, label );
   else
-    displayProgress( label, 0 );
+    displayProgress( id, label, 0 );
 
   _newline = false;
 }
@@ -191,9 +231,9 @@ void OutNormal::progress( const std::string & id, const std::string & label, int
     return;
 
   if (value)
-    displayProgress(label, value);
+    displayProgress(id, label, value);
   else
-    displayTick(label);
+    displayTick(id, label);
 
   _newline = false;
 }
@@ -203,19 +243,9 @@ void OutNormal::progressEnd( const std::string & id, const std::string & label,
   if ( progressFilter() )
     return;
 
-  if ( !error && _use_colors )
-    cout << ColorContext::MSG_STATUS;
-
   TermLine outstr( TermLine::SF_CRUSH | TermLine::SF_EXPAND, '.' );
   if ( _isatty )
   {
-    if ( _oneup )
-    {
-      cout << CLEARLN << CURSORUP(1);
-      _oneup = false;
-    }
-    cout << CLEARLN;
-
     outstr.lhs << label << ' ';
     outstr.rhs << '[';
     if ( error )
@@ -228,12 +258,7 @@ void OutNormal::progressEnd( const std::string & id, const std::string & label,
 
   outstr.rhs << ']';
 
-  std::string outline( outstr.get( termwidth() ) );
-  cout << outline << endl << std::flush;
-  _newline = true;
-
-  if ( !error && _use_colors )
-    cout << ColorContext::DEFAULT;
+  finishProgress( id, outstr.get( termwidth() ), error );
 }
 
 // progress with download rate
@@ -242,9 +267,6 @@ void OutNormal::dwnldProgressStart( const Url & uri )
   if ( verbosity() < NORMAL )
     return;
 
-  if ( _isatty )
-    cout << CLEARLN;
-
   TermLine outstr( TermLine::SF_CRUSH | TermLine::SF_EXPAND, '-' );
   outstr.lhs << _("Retrieving:") << ' ';
   if ( verbosity() == DEBUG )
@@ -258,8 +280,13 @@ void OutNormal::dwnldProgressStart( const Url & uri )
     outstr.rhs << '[' ;
 
   std::string outline( outstr.get( termwidth() ) );
-  cout << outline << std::flush;
-  // no _oneup if CRUSHed // _oneup = (outline.length() > termwidth());
+  if ( _isatty )
+    _progress.update( uri.asString(), std::move(outline) );
+  else
+  {
+    cout << outline << std::flush;
+    _lastDot = ProgressRenderer::Clock::time_point();
+  }
 
   _newline = false;
 }
@@ -269,15 +296,15 @@ void OutNormal::dwnldProgress( const Url & uri, int value, long rate )
   if ( verbosity() < NORMAL )
     return;
 
-  if ( !isatty(STDOUT_FILENO) )
+  if ( !_isatty )
   {
-    cout << '.' << std::flush;
+    displayDot();
     return;
   }
 
-  if( _oneup )
-    cout << CLEARLN << CURSORUP(1);
-  cout << CLEARLN;
+  std::string key( uri.asString() );
+  if ( ! _progress.due( key ) )
+    return;	// not before the next frame
 
   TermLine outstr( TermLine::SF_CRUSH | TermLine::SF_EXPAND, '-' );
   outstr.lhs << _("Retrieving:") << " ";
@@ -298,9 +325,7 @@ void OutNormal::dwnldProgress( const Url & uri, int value, long rate )
     outstr.rhs << " (" << ByteCount(rate) << "/s)";
   outstr.rhs << ']';
 
-  std::string outline( outstr.get( termwidth() ) );
-  cout << outline << std::flush;
-  // no _oneup if CRUSHed // _oneup = (outline.length() > termwidth());
+  _progress.update( key, outstr.get( termwidth() ) );
   _newline = false;
 }
 
@@ -309,15 +334,9 @@ void OutNormal::dwnldProgressEnd( const Url & uri, long rate, bool error )
   if ( verbosity() < NORMAL )
     return;
 
-  if ( !error && _use_colors )
-    cout << ColorContext::MSG_STATUS;
-
   TermLine outstr( TermLine::SF_CRUSH | TermLine::SF_EXPAND, '.' );
   if ( _isatty )
   {
-    if( _oneup )
-      cout << CLEARLN << CURSORUP(1);
-    cout << CLEARLN;
     outstr.lhs << _("Retrieving:") << " ";
     if ( verbosity() == DEBUG )
       outstr.lhs << uri;
@@ -337,18 +356,16 @@ void OutNormal::dwnldProgressEnd( const Url & uri, long rate, bool error )
     outstr.rhs << " (" << ByteCount(rate) << "/s)";
   outstr.rhs << ']';
 
-  std::string outline( outstr.get( termwidth() ) );
-  cout << outline << endl << std::flush;
-  _newline = true;
-
-  if ( !error && _use_colors )
-    cout << ColorContext::DEFAULT;
+  finishProgress( uri.asString(), outstr.get( termwidth() ), error );
 }
 
 void OutNormal::prompt( PromptId id, const std::string & prompt, const PromptOptions & poptions, const std::string & startdesc )
 {
   if ( !_newline )
+  {
     cout << endl;
+    _progress.detach();
+  }
 
   if ( startdesc.empty() )
   {
@@ -370,6 +387,7 @@ void OutNormal::prompt( PromptId id, const std::string & prompt, const PromptOpt
 void OutNormal::promptHelp( const PromptOptions & poptions )
 {
   cout << endl;
+  _progress.detach();
   if ( poptions.helpEmpty() )
     cout << _("No help available for this prompt.") << endl;
   else
@@ -9,6 +9,7 @@
 #define OUTNORMAL_H_
 
 #include "Out.h"
+#include "ProgressRenderer.h"
 #include <termios.h>
 #include <sys/ioctl.h>
 
@@ -85,16 +86,22 @@ protected:
 
 private:
   bool infoWarningFilter(Verbosity verbosity, Type mask);
-  void displayProgress(const std::string & s, int percent);
-  void displayTick(const std::string & s);
+  void displayProgress(const std::string & id, const std::string & s, int percent);
+  void displayTick(const std::string & id, const std::string & s);
+  /** Progress indicator if not on a terminal: at most one '.' per second. */
+  void displayDot();
+  /** Print the final line of a progress or download. */
+  void finishProgress(const std::string & id, const std::string & outline, bool error);
 
   bool _use_colors;
   bool _isatty;
   /* Newline flag. false if the last output did not end with new line character
    * (like in a self-overwriting progress line), false otherwise. */
   bool _newline;
-  /* True if the last output line was longer than the terminal width */
-  bool _oneup;
+  /* The self-overwriting lines of the running progresses (on a terminal) */
+  ProgressRenderer _progress;
+  /* When the last progress dot was printed (not on a terminal) */
+  ProgressRenderer::Clock::time_point _lastDot;
 };
 
 #endif /*OUTNORMAL_H_*/
@@ -3,11 +3,13 @@
 #include <vector>
 
 #include <zypp/base/String.h>
-#include <zypp/base/String.h>
+#include <zypp/Patch.h>
+#include <zypp/PoolItem.h>
 
 #include "OutXML.h"
+#include "XmlWriter.h"
 #include "utils/misc.h"
-#include "Table.h"
+#include "SearchResult.h"
 
 using std::cout;
 using std::endl;
@@ -148,65 +150,53 @@ void OutXML::dwnldProgressEnd( const Url & uri, long rate, bool error )
     << "/>" << endl;
 }
 
-void OutXML::searchResult( const Table & table_r )
+void OutXML::searchResult( const SearchResult & result_r )
 {
-  cout << "<search-result version=\"0.0\">" << endl;
-  cout << "<solvable-list>" << endl;
+  XmlWriter xml( cout );
+  xml << "<search-result version=\"0.0\">\n";
+  xml << "<solvable-list>\n";
 
-  const Table::container & rows( table_r.rows() );
-  if ( ! rows.empty() )
+  const SearchResult::container & rows( result_r.rows() );
+  for_( it, rows.begin(), rows.end() )
   {
-    //
-    // *** CAUTION: It's a mess, but must match the header list defined
-    //              in FillSearchTableSolvable ctor (search.cc)
-    // We derive the XML tag from the header, applying some translation
-    // hence and there.
-    std::vector<std::string> header;
+    PoolItem pi( it->_solvable );
+    xml << "<solvable";
+    switch ( it->_status )
     {
-      const TableHeader & theader( table_r.header() );
-      for_( it, theader.columns().begin(), theader.columns().end() )
-      {
-	if ( *it == "S" )
-	  header.push_back( "status" );
-	else if ( *it == "Type" )
-	  header.push_back( "kind" );
-	else if ( *it == "Version" )
-	  header.push_back( "edition" );
-	else
-	  header.push_back( str::toLower( *it ) );
-      }
+      case SearchResult::INSTALLED:	xml << " status=\"installed\"";	break;
+      case SearchResult::OTHER_VERSION:	xml << " status=\"other-version\"";	break;
+      case SearchResult::NOT_INSTALLED:	xml << " status=\"not-installed\"";	break;
     }
-
-    for_( it, rows.begin(), rows.end() )
+    xml << XmlWriter::Attr( "name", pi.name() );
+    switch ( result_r.style() )
     {
-      cout << "<solvable";
-      const TableRow::container & cols( it->columns() );
-      unsigned cidx = 0;
-      for_( cit, cols.begin(), cols.end() )
+      case SearchResult::SELECTABLES:
+	xml << XmlWriter::Attr( "summary", pi.summary() )
+	    << XmlWriter::Attr( "kind", pi.kind().asString() );
+	break;
+
+      case SearchResult::SOLVABLES:
+	xml << XmlWriter::Attr( "kind", pi.kind().asString() )
+	    << XmlWriter::Attr( "edition", pi.edition().asString() )
+	    << XmlWriter::Attr( "arch", pi.arch().asString() )
+	    << XmlWriter::Attr( "repository", SearchResult::repoString( it->_solvable ) );
+	break;
+
+      case SearchResult::PATCHES:
       {
-	cout << ' ' << (cidx < header.size() ? header[cidx] : "?" ) << "=\"";
-	if ( cidx == 0 )
-	{
-	  if ( (*cit)[0] == 'i' )	// test 1st char as locked is "iL"
-	    cout << "installed\"";
-	  else if ( (*cit)[0] == 'v' )	// test 1st char as locked is "vL"
-	    cout << "other-version\"";
-	  else
-	    cout << "not-installed\"";
-	}
-	else
-	{
-	  cout << xml::escape(*cit) << '"';
-	}
-	++cidx;
+	Patch::constPtr patch( asKind<Patch>( pi.resolvable() ) );
+	xml << XmlWriter::Attr( "kind", pi.kind().asString() )
+	    << XmlWriter::Attr( "category", patch->category() )
+	    << XmlWriter::Attr( "severity", patch->severity() )
+	    << XmlWriter::Attr( "repository", pi.repository().asUserString() );
+	break;
       }
-      cout << "/>" << endl;
     }
+    xml << "/>\n";
   }
-    //Out::searchResult( table_r );
 
-  cout << "</solvable-list>" << endl;
-  cout << "</search-result>" << endl;
+  xml << "</solvable-list>\n";
+  xml << "</search-result>\n";
 }
 
 void OutXML::prompt( PromptId id, const std::string & prompt, const PromptOptions & poptions, const std::string & startdesc )
@@ -37,7 +37,7 @@ public:
                                 long rate = -1,
                                 bool error = false);
 
-  virtual void searchResult( const Table & table_r );
+  virtual void searchResult( const SearchResult & result_r );
 
   virtual void prompt(PromptId id,
                       const std::string & prompt,
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <iostream>
+
+#include "AliveCursor.h"	// for CLEARLN
+#include "ProgressRenderer.h"
+
+ProgressRenderer::ProgressRenderer( std::ostream & out_r, Clock::duration frame_r )
+: _out( out_r )
+, _frame( frame_r )
+, _drawn( 0 )
+{}
+
+ProgressRenderer::Lines::iterator ProgressRenderer::find( const std::string & key_r )
+{
+  return std::find_if( _lines.begin(), _lines.end(), [&]( const Lines::value_type & line_r ) { return line_r.first == key_r; } );
+}
+
+ProgressRenderer::Lines::const_iterator ProgressRenderer::find( const std::string & key_r ) const
+{
+  return std::find_if( _lines.begin(), _lines.end(), [&]( const Lines::value_type & line_r ) { return line_r.first == key_r; } );
+}
+
+bool ProgressRenderer::due( const std::string & key_r ) const
+{
+  return _drawn == 0 || Clock::now() - _last >= _frame || find( key_r ) == _lines.end();
+}
+
+void ProgressRenderer::update( const std::string & key_r, std::string line_r )
+{
+  bool redraw = due( key_r );
+  Lines::iterator it( find( key_r ) );
+  if ( it == _lines.end() )
+    _lines.push_back( std::make_pair( key_r, std::move(line_r) ) );
+  else
+    it->second = std::move(line_r);
+
+  if ( redraw )
+    draw();
+}
+
+void ProgressRenderer::finish( const std::string & key_r, const std::string & line_r )
+{
+  Lines::iterator it( find( key_r ) );
+  if ( it != _lines.end() )
+    _lines.erase( it );
+
+  home();
+  _out << CLEARLN << line_r << '\n';
+  // the remaining lines are redrawn one line further down
+  _drawn = 0;
+  if ( ! _lines.empty() )
+    draw();
+  else
+    _out << std::flush;
+}
+
+void ProgressRenderer::home()
+{
+  if ( _drawn > 1 )
+    _out << "\x1B[" << ( _drawn - 1 ) << 'A';
+  _out << '\r';
+}
+
+void ProgressRenderer::draw()
+{
+  if ( _drawn )
+    home();
+  for ( Lines::size_type i = 0; i < _lines.size(); ++i )
+  {
+    if ( i )
+      _out << '\n';
+    _out << CLEARLN << _lines[i].second;
+  }
+  _out << std::flush;
+  _drawn = _lines.size();
+  _last = Clock::now();
+}
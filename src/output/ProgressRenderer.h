@@ -0,0 +1,70 @@
+#ifndef PROGRESSRENDERER_H_
+#define PROGRESSRENDERER_H_
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////
+/// \class ProgressRenderer
+/// \brief The self-overwriting progress lines of \ref OutNormal on a terminal.
+///
+/// Each running progress (or download) has a line of its own, in the
+/// order they were started, so concurrent ones don't overwrite each
+/// other. The block of lines is redrawn at most once per frame (and when
+/// a line is added): callers check \ref due and skip formatting updates
+/// in between, so fast callbacks cost next to nothing. When a progress
+/// finishes, its final line is printed above the block of the ones still
+/// running.
+///
+/// The cursor is left at the end of the block's last line. If anything
+/// else is printed meanwhile, \ref detach must be called, so the next
+/// redraw starts below it instead of overwriting it.
+///////////////////////////////////////////////////////////////////
+class ProgressRenderer
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  explicit ProgressRenderer( std::ostream & out_r, Clock::duration frame_r = std::chrono::milliseconds( 100 ) );
+
+  /** Whether \a key_r is new or the next frame is due, i.e. whether
+   * \ref update would redraw. Callers may skip building the line otherwise.
+   */
+  bool due( const std::string & key_r ) const;
+
+  /** Set the line of \a key_r (adding it if new) and redraw if \ref due. */
+  void update( const std::string & key_r, std::string line_r );
+
+  /** Remove \a key_r, printing \a line_r as its final line (NL appended). */
+  void finish( const std::string & key_r, const std::string & line_r );
+
+  /** Forget about the block on screen (other output was printed below it). */
+  void detach()
+  { _drawn = 0; }
+
+  /** Whether no progress is running. */
+  bool empty() const
+  { return _lines.empty(); }
+
+private:
+  typedef std::vector<std::pair<std::string,std::string>> Lines;	//< key, line
+
+  Lines::iterator find( const std::string & key_r );
+  Lines::const_iterator find( const std::string & key_r ) const;
+
+  /** Move to the start of the block on screen. */
+  void home();
+  /** Draw all lines and remember the time. */
+  void draw();
+
+  std::ostream & _out;
+  Clock::duration _frame;
+  Clock::time_point _last;
+  Lines _lines;
+  unsigned _drawn;	//< number of lines drawn on screen (0: none)
+};
+
+#endif /*PROGRESSRENDERER_H_*/
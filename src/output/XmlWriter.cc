@@ -0,0 +1,104 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include "XmlWriter.h"
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  const uint64_t ones  = 0x0101010101010101ULL;
+  const uint64_t highs = 0x8080808080808080ULL;
+
+  /** Whether any byte of \a word_r is zero. */
+  inline bool hasZeroByte( uint64_t word_r )
+  { return ( ( word_r - ones ) & ~word_r & highs ) != 0; }
+
+  /** Whether any byte of \a word_r is \a ch_r. */
+  inline bool hasByte( uint64_t word_r, unsigned char ch_r )
+  { return hasZeroByte( word_r ^ ( ones * ch_r ) ); }
+
+  /** Whether any of the 8 bytes at \a p_r needs to be escaped. */
+  inline bool needsEscape( const char * p_r )
+  {
+    uint64_t word;
+    ::memcpy( &word, p_r, sizeof(word) );
+    return hasByte( word, '<' ) || hasByte( word, '>' ) || hasByte( word, '&' )
+	|| hasByte( word, '"' ) || hasByte( word, '\'' );
+  }
+
+  /** The escape sequence for \a ch_r, or \c nullptr. */
+  inline const char * escapeFor( char ch_r )
+  {
+    switch ( ch_r )
+    {
+      case '<':  return "&lt;";
+      case '>':  return "&gt;";
+      case '&':  return "&amp;";
+      case '"':  return "&quot;";
+      case '\'': return "&apos;";
+    }
+    return nullptr;
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+XmlWriter::XmlWriter( std::ostream & out_r, std::string::size_type blockSize_r )
+: _out( out_r )
+, _blockSize( blockSize_r )
+{ _buf.reserve( _blockSize + 4096 ); }
+
+XmlWriter::~XmlWriter()
+{ flush(); }
+
+XmlWriter & XmlWriter::operator<<( const Attr & attr_r )
+{
+  _buf += ' ';
+  _buf.append( attr_r._name.data(), attr_r._name.size() );
+  _buf += "=\"";
+  escapeTo( _buf, attr_r._value );
+  _buf += '"';
+  return checkBlock();
+}
+
+void XmlWriter::flush()
+{
+  writeBlock();
+  _out.flush();
+}
+
+void XmlWriter::writeBlock()
+{
+  if ( ! _buf.empty() )
+  {
+    _out.write( _buf.data(), _buf.size() );
+    _buf.clear();
+  }
+}
+
+void XmlWriter::escapeTo( std::string & buf_r, boost::string_ref text_r )
+{
+  const char * p = text_r.data();
+  const char * end = p + text_r.size();
+  const char * clean = p;	// start of the pending clean run
+
+  while ( p != end )
+  {
+    // skip clean words
+    while ( end - p >= 8 && ! needsEscape( p ) )
+      p += 8;
+    // then look at single chars up to the next clean word
+    const char * stop = ( end - p >= 8 ? p + 8 : end );
+    for ( ; p != stop; ++p )
+    {
+      const char * esc = escapeFor( *p );
+      if ( esc )
+      {
+	buf_r.append( clean, p - clean );
+	buf_r += esc;
+	clean = p + 1;
+      }
+    }
+  }
+  buf_r.append( clean, end - clean );
+}
@@ -0,0 +1,108 @@
+#ifndef XMLWRITER_H_
+#define XMLWRITER_H_
+
+#include <iosfwd>
+#include <string>
+#include <type_traits>
+
+#include <boost/utility/string_ref.hpp>
+
+///////////////////////////////////////////////////////////////////
+/// \class XmlWriter
+/// \brief Buffered writer for big XML listings.
+///
+/// Markup is appended to a reusable buffer as it is, text is escaped
+/// right into it (same as \ref zypp::xml::escape, but without a temporary
+/// string per call). Runs of text not needing escapes are found a word at
+/// a time and copied as a block. The buffer is written to the stream in
+/// large blocks, and finally (and flushed) when the writer goes away, so
+/// don't write to the stream otherwise meanwhile.
+///
+/// \code
+///   XmlWriter xml( cout );
+///   xml << "<solvable" << XmlWriter::Attr( "name", name ) << "/>\n";
+///   xml << "<summary>" << XmlWriter::Text( summary ) << "</summary>\n";
+/// \endcode
+///////////////////////////////////////////////////////////////////
+class XmlWriter
+{
+public:
+  /** Text to be escaped. */
+  struct Text
+  {
+    explicit Text( boost::string_ref text_r ) : _text( text_r ) {}
+    boost::string_ref _text;
+  };
+
+  /** <tt> name="value"</tt> attribute, the value escaped. */
+  struct Attr
+  {
+    Attr( boost::string_ref name_r, boost::string_ref value_r ) : _name( name_r ), _value( value_r ) {}
+    boost::string_ref _name;
+    boost::string_ref _value;
+  };
+
+public:
+  explicit XmlWriter( std::ostream & out_r, std::string::size_type blockSize_r = 64 * 1024 );
+  ~XmlWriter();
+
+  XmlWriter( const XmlWriter & ) = delete;
+  XmlWriter & operator=( const XmlWriter & ) = delete;
+
+  /** Append markup (not escaped). */
+  XmlWriter & operator<<( boost::string_ref markup_r )
+  { _buf.append( markup_r.data(), markup_r.size() ); return checkBlock(); }
+
+  XmlWriter & operator<<( const char * markup_r )
+  { return operator<<( boost::string_ref( markup_r ) ); }
+
+  XmlWriter & operator<<( const std::string & markup_r )
+  { return operator<<( boost::string_ref( markup_r ) ); }
+
+  XmlWriter & operator<<( char ch_r )
+  { _buf += ch_r; return checkBlock(); }
+
+  /** Integers, as \c std::ostream would write them. */
+  template <class Tp>
+  typename std::enable_if<std::is_integral<Tp>::value, XmlWriter &>::type operator<<( Tp num_r )
+  { _buf += std::to_string( num_r ); return checkBlock(); }
+
+  /** Not for floating point: \c std::to_string formats them unlike \c std::ostream
+   * (and they must not be converted to \c char either).
+   */
+  template <class Tp>
+  typename std::enable_if<std::is_floating_point<Tp>::value, XmlWriter &>::type operator<<( Tp num_r ) = delete;
+
+  /** Objects providing \c asString(), like \ref zypp::Edition or \ref zypp::Arch. */
+  template <class Tp>
+  typename std::enable_if<!std::is_arithmetic<Tp>::value, XmlWriter &>::type operator<<( const Tp & obj_r )
+  { return operator<<( obj_r.asString() ); }
+
+  XmlWriter & operator<<( const Text & text_r )
+  { escapeTo( _buf, text_r._text ); return checkBlock(); }
+
+  XmlWriter & operator<<( const Attr & attr_r );
+
+  /** Write the buffer to the stream and flush it. */
+  void flush();
+
+public:
+  /** Append \a text_r escaped to \a buf_r. */
+  static void escapeTo( std::string & buf_r, boost::string_ref text_r );
+
+  /** \a text_r escaped. */
+  static std::string escape( boost::string_ref text_r )
+  { std::string ret; escapeTo( ret, text_r ); return ret; }
+
+private:
+  XmlWriter & checkBlock()
+  { if ( _buf.size() >= _blockSize ) writeBlock(); return *this; }
+
+  void writeBlock();
+
+  std::ostream & _out;
+  std::string::size_type _blockSize;
+  std::string _buf;
+};
+
+#endif /*XMLWRITER_H_*/
@@ -9,11 +9,11 @@
 
 #include <zypp/base/LogTools.h>
 #include <zypp/ExternalProgram.h>
-#include <zypp/misc/CheckAccessDeleted.h>
 
 #include "Zypper.h"
 #include "Table.h"
 #include "ps.h"
+#include "utils/ProcScanner.h"
 
 ///////////////////////////////////////////////////////////////////
 // PsOptions
@@ -48,11 +48,11 @@ namespace
   };
   ///////////////////////////////////////////////////////////////////
 
-  inline void loadData( CheckAccessDeleted & checker_r )
+  inline void loadData( ProcScanner & checker_r )
   {
     try
     {
-      checker_r.check();
+      checker_r.scan();
     }
     catch ( const Exception & ex )
     {
@@ -62,15 +62,14 @@ namespace
 
   void PsImpl::printServiceNamesOnly()
   {
-    CheckAccessDeleted checker( false );	// wait for explicit call to check()
+    ProcScanner checker;
     loadData( checker );
 
     std::set<std::string> services;
     for ( const auto & procInfo : checker )
     {
-      std::string service( procInfo.service() );
-      if ( ! service.empty() )
-	services.insert( std::move(service) );
+      if ( ! procInfo.service.empty() )
+	services.insert( procInfo.service );
     }
 
     const std::string & format( options()._format );
@@ -102,7 +101,7 @@ namespace
 
     // Here: Table output
     _zypper.out().info(_("Checking for running processes using deleted libraries..."), Out::HIGH );
-    CheckAccessDeleted checker( false );	// wait for explicit call to check()
+    ProcScanner checker;
     loadData( checker );
 
     Table t;
@@ -133,12 +132,11 @@ namespace
 
     for ( const auto & procInfo : checker )
     {
-      std::string service( procInfo.service() );
-      if ( ! tableWithNonServiceProcs && service.empty() )
+      if ( ! tableWithNonServiceProcs && procInfo.service.empty() )
 	continue;
 
       TableRow tr;
-      tr << procInfo.pid << procInfo.ppid << procInfo.puid << procInfo.login << procInfo.command << std::move(service);
+      tr << procInfo.pid << procInfo.ppid << procInfo.puid << procInfo.login << procInfo.command << procInfo.service;
 
       if ( tableWithFiles )
       {
@@ -19,6 +19,7 @@
 #include <zypp/base/Flags.h>
 
 #include <zypp/RepoManager.h>
+#include <zypp/Locks.h>
 #include <zypp/repo/RepoException.h>
 #include <zypp/parser/ParseException.h>
 #include <zypp/media/MediaException.h>
@@ -30,7 +31,10 @@
 #include "Table.h"
 #include "utils/messages.h"
 #include "utils/misc.h"
+#include "misc.h"
+#include "solve-commit.h"
 #include "repos.h"
+#include "SearchIndex.h"
 
 extern ZYpp::Ptr God;
 
@@ -381,6 +385,11 @@ static bool build_cache( Zypper & zypper, const RepoInfo & repo, bool force_buil
     {
       manager.loadFromCache( repo );
     }
+
+    // Keep the search indexes next to the solv file up to date (refresh only,
+    // as it may need to load the repo).
+    if ( zypper.command() == ZypperCommand::REFRESH || zypper.command() == ZypperCommand::REFRESH_SERVICES )
+      SearchIndex::update( zypper, repo );
   }
   catch ( const parser::ParseException & e )
   {
@@ -891,6 +900,51 @@ void init_target( Zypper & zypper )
 
 // ----------------------------------------------------------------------------
 
+void switch_target( Zypper & zypper, const std::string & root_r )
+{
+  MIL << "Switching target to " << root_r << endl;
+  zypper.out().info( str::Format(_("Initializing Target in '%s'")) % root_r, Out::HIGH );
+
+  // drop what was selected and solved for the previous target
+  remove_selections( zypper );
+  God->resolver()->undo();
+
+  try
+  {
+    God->finishTarget();	// unloads the previous system repo
+    God->initializeTarget( root_r );
+  }
+  catch ( const Exception & e )
+  {
+    zypper.out().error( e, _("Target initialization failed:" ) );
+    zypper.setExitCode( ZYPPER_EXIT_ERR_ZYPP );
+    ZYPP_THROW( ExitRequestException("Target initialization failed: " + e.msg()) );
+  }
+
+  if ( !zypper.globalOpts().disable_system_resolvables )
+  {
+    load_target_resolvables( zypper );
+    if ( zypper.exitCode() != ZYPPER_EXIT_OK )
+      ZYPP_THROW( ExitRequestException("Loading the target failed") );
+  }
+
+  // libzypp applies the locks file only if it is not empty; set the
+  // locks of this root (maybe none) explicitly to drop the previous ones.
+  ResPool::HardLockQueries locks;
+  if ( ZConfig::instance().apply_locks_file() )
+  {
+    Locks::instance().read( Pathname::assertprefix( root_r, ZConfig::instance().locksFile() ) );
+    locks.assign( Locks::instance().begin(), Locks::instance().end() );
+  }
+  DBG << locks.size() << " locks in " << root_r << endl;
+  ResPool::instance().setHardLockQueries( locks );
+
+  // compute status of PPP
+  resolve( zypper );
+}
+
+// ----------------------------------------------------------------------------
+
 static void print_repo_list( Zypper & zypper, const std::list<RepoInfo> & repos )
 {
   Table tbl;
@@ -3117,6 +3171,10 @@ void load_repo_resolvables( Zypper & zypper )
 
       manager.loadFromCache( repo );
 
+      // An autorefresh may have rebuilt the solv file, which leaves its
+      // search indexes stale. Rebuild them now the repo is loaded anyway.
+      SearchIndex::update( zypper, repo );
+
       // check that the metadata is not outdated
       // feature #301904
       // ma@: Using God->pool() here would always rebuild the pools index tables,
@@ -3161,7 +3219,14 @@ void load_target_resolvables(Zypper & zypper)
     zypper.out().error( e, _("Problem occurred while reading the installed packages:"),
 			_("Please see the above error message for a hint.") );
     zypper.setExitCode( ZYPPER_EXIT_ERR_ZYPP );
+    return;
   }
+
+  // keep the installed names for 'zypper complete' up to date
+  // (with several --root options our solv cache is the one of the first root)
+  const GlobalOptions & gopts( zypper.globalOpts() );
+  if ( gopts.root_dirs.empty() || gopts.root_dir == gopts.root_dirs.front() )
+    SearchIndex::update( zypper, sat::Pool::instance().findSystemRepo(), SearchIndex::NAME_INDEX );
 }
 
 // ---------------------------------------------------------------------------
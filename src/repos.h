@@ -191,6 +191,14 @@ void modify_services_by_option( Zypper & zypper );
  */
 void init_target( Zypper & zypper );
 
+/**
+ * Replace the initialized target by the one in \a root_r and load it
+ * into the pool, keeping the loaded repos (multi-root mode). Selections
+ * and solver results of the previous target are dropped, the locks of
+ * \a root_r are applied.
+ */
+void switch_target( Zypper & zypper, const std::string & root_r );
+
 /**
  * Load both repository and target resolvables.
  *
@@ -1,12 +1,22 @@
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
 
 #include <zypp/ZYpp.h> // for ResPool::instance()
 
 #include <zypp/base/Logger.h>
 #include <zypp/base/Algorithm.h>
+#include <zypp/base/StrMatcher.h>
 #include <zypp/Patch.h>
 #include <zypp/Pattern.h>
 #include <zypp/Product.h>
+#include <zypp/sat/LookupAttr.h>
+#include <zypp/sat/Pool.h>
 #include <zypp/sat/Solvable.h>
 
 #include <zypp/PoolItem.h>
@@ -18,6 +28,7 @@
 #include "utils/misc.h" // for kind_to_string_localized and string_patch_status
 
 #include "search.h"
+#include "SearchIndex.h"
 
 extern ZYpp::Ptr God;
 
@@ -40,11 +51,101 @@ namespace
     return tag_r;
   }
 
+  /** Whether \a query_r searches in \a repo_r. */
+  bool searchesRepo( const PoolQuery & query_r, const sat::Repository & repo_r )
+  {
+    if ( repo_r.isSystemRepo() && query_r.statusFilterFlags() == PoolQuery::UNINSTALLED_ONLY )
+      return false;
+    const PoolQuery::StrContainer & repos( query_r.repos() );
+    return repos.empty() || repos.find( repo_r.alias() ) != repos.end();
+  }
+
+  /** Whether \a query_r searches for \a solv_r's kind. */
+  inline bool searchesKind( const PoolQuery & query_r, const sat::Solvable & solv_r )
+  {
+    const PoolQuery::Kinds & kinds( query_r.kinds() );
+    return kinds.empty() || kinds.find( solv_r.kind() ) != kinds.end();
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class SearchRepos
+  /// \brief The repos searched by a query, with their search indexes.
+  ///
+  /// Index files are built when refreshing or loading repos, not here;
+  /// repos without them are searched by scanning all their solvables.
+  ///////////////////////////////////////////////////////////////////
+  class SearchRepos
+  {
+  public:
+    SearchRepos( Zypper & zypper_r, const PoolQuery & query_r )
+    {
+      for_( it, sat::Pool::instance().reposBegin(), sat::Pool::instance().reposEnd() )
+      {
+	sat::Repository repo( *it );
+	if ( ! searchesRepo( query_r, repo ) )
+	  continue;
+	_indexes.push_back( std::unique_ptr<SearchIndex>( new SearchIndex( zypper_r, repo ) ) );
+	if ( ! _indexes.back()->hasTextIndex() || ! _indexes.back()->hasPathIndex() )
+	  DBG << "No up to date search index for " << repo.alias() << ", scanning it" << endl;
+      }
+    }
+
+    unsigned size() const
+    { return _indexes.size(); }
+
+    const SearchIndex & index( unsigned idx_r ) const
+    { return *_indexes[idx_r]; }
+
+  private:
+    std::vector<std::unique_ptr<SearchIndex>> _indexes;
+  };
+
+  /** Invoke \a fnc_r( i ) for all \c i in [0,count_r) using up to 8 threads.
+   * \note \a fnc_r must neither log nor use libsolv without a lock.
+   */
+  template <class Fnc>
+  void parallel_for( unsigned count_r, Fnc fnc_r )
+  {
+    unsigned nthreads = std::min( std::max( std::thread::hardware_concurrency(), 1U ), 8U );
+    nthreads = std::min( nthreads, count_r );
+
+    std::atomic<unsigned> next( 0 );
+    auto work = [&]() {
+      for ( unsigned idx = next++; idx < count_r; idx = next++ )
+	fnc_r( idx );
+    };
+    std::vector<std::thread> threads;
+    for ( unsigned i = 1; i < nthreads; ++i )
+    {
+      try { threads.push_back( std::thread( work ) ); }
+      catch ( const std::system_error & ) { break; }	// fewer threads then
+    }
+    work();
+    for ( auto & thread : threads )
+      thread.join();
+  }
+
+  /** Sort \a solvables_r in pool order and remove duplicates. */
+  void inPoolOrder( std::vector<sat::Solvable> & solvables_r )
+  {
+    std::sort( solvables_r.begin(), solvables_r.end(), []( const sat::Solvable & lhs, const sat::Solvable & rhs ) {
+      return lhs.id() < rhs.id();
+    } );
+    solvables_r.erase( std::unique( solvables_r.begin(), solvables_r.end() ), solvables_r.end() );
+  }
+
+  inline bool hasNonAscii( const std::string & str_r )
+  { return std::find_if( str_r.begin(), str_r.end(), []( char ch ) { return (unsigned char)ch >= 0x80; } ) != str_r.end(); }
+
+  /** Regex special characters; PoolQuery uses words unescaped in a regex. */
+  inline bool hasRegexChars( const std::string & str_r )
+  { return str_r.find_first_of( ".[]()*+?{}|^$\\" ) != std::string::npos; }
+
 } // namespace
 ///////////////////////////////////////////////////////////////////
 
-FillSearchTableSolvable::FillSearchTableSolvable( Table & table, TriBool inst_notinst )
-: _table( &table )
+FillSearchTableSolvable::FillSearchTableSolvable( SearchResult & result, TriBool inst_notinst )
+: _result( &result )
 , _gopts( Zypper::instance()->globalOpts() )
 , _inst_notinst( inst_notinst )
 {
@@ -55,24 +156,7 @@ FillSearchTableSolvable::FillSearchTableSolvable( Table & table, TriBool inst_no
     for_( it, repos.begin(), repos.end() )
       _repos.insert( it->alias() );
   }
-
-  //
-  // *** CAUTION: It's a mess, but adding/changing colums here requires
-  //              adapting OutXML::searchResult !
-  //
-  *_table << ( TableHeader()
-	  // translators: S for 'installed Status'
-	  << _("S")
-	  // translators: name (general header)
-	  << _("Name")
-	  // translators: type (general header)
-	  << _("Type")
-	  // translators: package version (header)
-	  << table::EditionStyleSetter( *_table, _("Version") )
-	  // translators: package architecture (header)
-	  << _("Arch")
-	  // translators: package's repository (header)
-	  << _("Repository") );
+  _result->setStyle( SearchResult::SOLVABLES );
 }
 
 bool FillSearchTableSolvable::addPicklistItem( const ui::Selectable::constPtr & sel, const PoolItem & pi ) const
@@ -85,18 +169,17 @@ bool FillSearchTableSolvable::addPicklistItem( const ui::Selectable::constPtr &
   if ( pi->isKind<Pattern>() && ! pi->asKind<Pattern>()->userVisible() )
     return false;
 
-  TableRow row;
   // compute status indicator:
   //   i  - exactly this version installed
   //   v  - installed, but in different version
   //      - not installed at all
-  bool isLocked = pi.status().isLocked();
+  SearchResult::Status status;
   if ( pi->isSystem() )
   {
     // picklist: ==> not available
     if ( _inst_notinst == false )
       return false;	// show only not installed
-    row << lockStatusTag( "i", isLocked );
+    status = SearchResult::INSTALLED;
   }
   else
   {
@@ -107,7 +190,7 @@ bool FillSearchTableSolvable::addPicklistItem( const ui::Selectable::constPtr &
     {
       if ( _inst_notinst == true )
 	return false;	// show only installed
-      row << lockStatusTag( "", isLocked );
+      status = SearchResult::NOT_INSTALLED;
     }
     else
     {
@@ -118,27 +201,18 @@ bool FillSearchTableSolvable::addPicklistItem( const ui::Selectable::constPtr &
       {
 	if ( _inst_notinst == false )
 	  return false;	// show only not installed
-	row << lockStatusTag( "i", isLocked );
+	status = SearchResult::INSTALLED;
       }
       else
       {
 	if ( _inst_notinst == true )
 	  return false;	// show only installed
-	row << lockStatusTag( "v", isLocked );
+	status = SearchResult::OTHER_VERSION;
       }
     }
   }
 
-  row
-    << pi->name()
-    << kind_to_string_localized( pi->kind(), 1 )
-    << pi->edition().asString()
-    << pi->arch().asString()
-    << ( pi->isSystem()
-       ? (std::string("(") + _("System Packages") + ")")
-       : pi->repository().asUserString() );
-
-  *_table << row;
+  _result->add( SearchResult::Row( pi.satSolvable(), status, pi.status().isLocked() ) );
   return true;	// actually added a row
 }
 
@@ -153,7 +227,7 @@ bool FillSearchTableSolvable::operator()( const PoolQuery::const_iterator & it )
 
   // after addPicklistItem( const ui::Selectable::constPtr & sel, const PoolItem & pi ) is
   // done, add the details about matches to last row
-  TableRow & lastRow( _table->rows().back() );
+  std::vector<std::string> & details( _result->rows().back()._details );
 
   // don't show details for patterns with user visible flag not set (bnc #538152)
   if ( it->kind() == ResKind::pattern )
@@ -175,13 +249,13 @@ bool FillSearchTableSolvable::operator()( const PoolQuery::const_iterator & it )
            match->inSolvAttr() == sat::SolvAttr::description )
       {
 	// multiline matchstring
-        lastRow.addDetail( attrib + ":" );
-        lastRow.addDetail( match->asString() );
+        details.push_back( attrib + ":" );
+        details.push_back( match->asString() );
       }
       else
       {
         // print attribute and match in one line, e.g. requires: libzypp >= 11.6.2
-        lastRow.addDetail( attrib + ": " + match->asString() );
+        details.push_back( attrib + ": " + match->asString() );
       }
     }
   }
@@ -210,8 +284,8 @@ bool FillSearchTableSolvable::operator()( const ui::Selectable::constPtr & sel )
 }
 
 
-FillSearchTableSelectable::FillSearchTableSelectable( Table & table, TriBool installed_only )
-: _table( &table )
+FillSearchTableSelectable::FillSearchTableSelectable( SearchResult & result, TriBool installed_only )
+: _result( &result )
 , _gopts( Zypper::instance()->globalOpts() )
 , inst_notinst( installed_only )
 {
@@ -222,19 +296,7 @@ FillSearchTableSelectable::FillSearchTableSelectable( Table & table, TriBool ins
     for_( it, repos.begin(), repos.end() )
       _repos.insert( it->alias() );
   }
-
-  TableHeader header;
-  //
-  // *** CAUTION: It's a mess, but adding/changing colums here requires
-  //              adapting OutXML::searchResult !
-  //
-  // translators: S for installed Status
-  header << _("S");
-  header << _("Name");
-  // translators: package summary (header)
-  header << _("Summary");
-  header << _("Type");
-  *_table << header;
+  _result->setStyle( SearchResult::SELECTABLES );
 }
 
 bool FillSearchTableSelectable::operator()( const ui::Selectable::constPtr & s ) const
@@ -247,8 +309,6 @@ bool FillSearchTableSelectable::operator()( const ui::Selectable::constPtr & s )
       return true;
   }
 
-  TableRow row;
-
   // whether to show the solvable as 'installed'
   bool installed = false;
 
@@ -270,7 +330,7 @@ bool FillSearchTableSelectable::operator()( const ui::Selectable::constPtr & s )
   else
     installed = !s->installedEmpty();
 
-  bool isLocked = s->locked();
+  SearchResult::Status status;
   if ( s->kind() != ResKind::srcpackage )
   {
     if ( installed )
@@ -278,7 +338,7 @@ bool FillSearchTableSelectable::operator()( const ui::Selectable::constPtr & s )
       // not-installed only
       if ( inst_notinst == false )
         return true;
-      row << lockStatusTag( "i", isLocked );
+      status = SearchResult::INSTALLED;
     }
     // this happens if the solvable has installed objects, but no counterpart
     // of them in specified repos
@@ -287,14 +347,14 @@ bool FillSearchTableSelectable::operator()( const ui::Selectable::constPtr & s )
       // not-installed only
       if ( inst_notinst == true )
         return true;
-      row << lockStatusTag( "v", isLocked );
+      status = SearchResult::OTHER_VERSION;
     }
     else
     {
       // installed only
       if ( inst_notinst == true )
         return true;
-      row << lockStatusTag( "", isLocked );
+      status = SearchResult::NOT_INSTALLED;
     }
   }
   else
@@ -302,32 +362,20 @@ bool FillSearchTableSelectable::operator()( const ui::Selectable::constPtr & s )
     // installed only
     if ( inst_notinst == true )
       return true;
-    row << lockStatusTag( "", isLocked );
+    status = SearchResult::NOT_INSTALLED;
   }
 
-  row << s->name();
-  row << s->theObj()->summary();
-  row << kind_to_string_localized( s->kind(), 1 );
-  *_table << row;
+  _result->add( SearchResult::Row( s->theObj().satSolvable(), status, s->locked() ) );
   return true;
 }
 
 
-FillPatchesTable::FillPatchesTable( Table & table, TriBool inst_notinst )
-: _table( &table )
+FillPatchesTable::FillPatchesTable( SearchResult & result, TriBool inst_notinst )
+: _result( &result )
 , _gopts( Zypper::instance()->globalOpts() )
 , _inst_notinst( inst_notinst )
 {
-  TableHeader header;
-
-  header
-    << _("Repository")
-    << _("Name")
-    << _("Category")
-    << _("Severity")
-    << _("Status");
-
-  *_table << header;
+  _result->setStyle( SearchResult::PATCHES );
 }
 
 bool FillPatchesTable::operator()( const PoolItem & pi ) const
@@ -339,19 +387,8 @@ bool FillPatchesTable::operator()( const PoolItem & pi ) const
   else if ( !pi.isSatisfied() && _inst_notinst == true )
     return true;
 
-  TableRow row;
-
-  Patch::constPtr patch = asKind<Patch>(pi.resolvable());
-
-  row
-    << pi.repository().asUserString()
-    << pi.name()
-    << patch->category()
-    << patch->severity()
-    << string_patch_status( pi );
-
-  *_table << row;
-
+  _result->add( SearchResult::Row( pi.satSolvable(),
+				   pi.isSatisfied() ? SearchResult::INSTALLED : SearchResult::NOT_INSTALLED ) );
   return true;
 }
 
@@ -391,19 +428,25 @@ void list_patches( Zypper & zypper )
 {
   MIL << "Pool contains " << God->pool().size() << " items. Checking whether available patches are needed." << std::endl;
 
-  Table tbl;
+  SearchResult result;
 
-  FillPatchesTable callback( tbl );
+  FillPatchesTable callback( result );
   invokeOnEach( God->pool().byKindBegin(ResKind::patch),
 		God->pool().byKindEnd(ResKind::patch),
 		callback);
-  tbl.sort( 1 );	// Name
+  result.sortByName();
 
-  if ( tbl.empty() )
+  if ( result.empty() )
     zypper.out().info( _("No needed patches found.") );
+  else if ( zypper.out().typeJSON() )
+    zypper.out().searchResult( result );
   else
+  {
     // display the result, even if --quiet specified
+    Table tbl;
+    result.fillTable( tbl );
     cout << tbl;
+  }
 }
 
 static void list_patterns_xml( Zypper & zypper )
@@ -487,6 +530,7 @@ void list_packages( Zypper & zypper )
 {
   MIL << "Going to list packages." << std::endl;
   Table tbl;
+  SearchResult result( SearchResult::SOLVABLES );	// JSON output
 
   const auto & copts( zypper.cOpts() );
   bool installed_only = copts.count("installed-only");
@@ -547,6 +591,15 @@ void list_packages( Zypper & zypper )
 	}
       }
 
+      if ( zypper.out().typeJSON() )
+      {
+	SearchResult::Status status( ! s->hasInstalledObj() ? SearchResult::NOT_INSTALLED
+				     : pi.status().isInstalled() || s->identicalInstalled( pi ) ? SearchResult::INSTALLED
+				     : SearchResult::OTHER_VERSION );
+	result.add( SearchResult::Row( pi.satSolvable(), status, pi.status().isLocked() ) );
+	continue;
+      }
+
       TableRow row;
       bool isLocked = pi.status().isLocked();
       if ( s->hasInstalledObj() )
@@ -565,6 +618,19 @@ void list_packages( Zypper & zypper )
     }
   }
 
+  if ( zypper.out().typeJSON() )
+  {
+    if ( zypper.cOpts().count("sort-by-repo") )
+      result.sortByRepo();
+    else
+      result.sortByName();
+    if ( result.empty() )
+      zypper.out().info(_("No packages found.") );
+    else
+      zypper.out().searchResult( result );
+    return;
+  }
+
   if ( tbl.empty() )
     zypper.out().info(_("No packages found.") );
   else
@@ -726,6 +792,294 @@ void list_products( Zypper & zypper )
     list_product_table( zypper );
 }
 
+void search_descriptions( Zypper & zypper, const PoolQuery & query,
+                          const std::vector<std::string> & terms,
+                          std::vector<sat::Solvable> & result )
+{
+  Match flags( query.matchRegex() || query.matchWord() ? Match::REGEX
+             : query.matchGlob() ? Match::GLOB
+             : query.matchExact() ? Match::STRING : Match::SUBSTRING );
+  if ( ! query.caseSensitive() )
+    flags |= Match::NOCASE;
+
+  // The index tells which solvables contain a substring, ignoring case.
+  // Exact and word matches are substring matches, too. Globs and regexes
+  // can't be looked up, neither can case insensitive non-ASCII terms (a
+  // regex may fold them, the index does not). Those are matched against
+  // all solvables instead.
+  std::vector<StrMatcher> matchers;
+  std::vector<bool> lookup;
+  for_( it, terms.begin(), terms.end() )
+  {
+    // PoolQuery uses words unescaped in a regex, enclosed in word boundaries.
+    matchers.push_back( StrMatcher( query.matchWord() ? "\\b" + *it + "\\b" : *it, flags ) );
+    matchers.back().compile();
+    lookup.push_back( !query.matchRegex() && !query.matchGlob()
+                      && !( query.matchWord() && hasRegexChars( *it ) )
+                      && !( ! query.caseSensitive() && hasNonAscii( *it ) ) );
+  }
+
+  SearchRepos repos( zypper, query );
+
+  // candidates per repo and term
+  std::vector<std::vector<sat::Solvable>> candidates( repos.size() * terms.size() );
+  parallel_for( candidates.size(), [&]( unsigned idx_r ) {
+    const SearchIndex & index( repos.index( idx_r / terms.size() ) );
+    unsigned term = idx_r % terms.size();
+    if ( ! lookup[term] || ! index.textCandidates( terms[term], candidates[idx_r] ) )
+      candidates[idx_r] = index.solvables();
+  } );
+
+  // Match the candidates in batches. The texts are retrieved from libsolv
+  // with the lock held, the (maybe expensive) matching is done in parallel.
+  struct Batch
+  {
+    unsigned _term;
+    const sat::Solvable * _begin;
+    const sat::Solvable * _end;
+    std::vector<sat::Solvable> _matches;
+  };
+  std::vector<Batch> batches;
+  for ( unsigned i = 0; i < candidates.size(); ++i )
+  {
+    const std::vector<sat::Solvable> & cand( candidates[i] );
+    for ( size_t off = 0; off < cand.size(); off += 256 )
+      batches.push_back( Batch{ unsigned(i % terms.size()), cand.data() + off, cand.data() + std::min( off + 256, cand.size() ), {} } );
+  }
+
+  std::mutex satLock;
+  parallel_for( batches.size(), [&]( unsigned idx_r ) {
+    Batch & batch( batches[idx_r] );
+    std::vector<std::string> texts;
+    {
+      std::lock_guard<std::mutex> guard( satLock );
+      for ( const sat::Solvable * it = batch._begin; it != batch._end; ++it )
+      {
+	texts.push_back( it->lookupStrAttribute( sat::SolvAttr::summary ) );
+	texts.push_back( it->lookupStrAttribute( sat::SolvAttr::description ) );
+      }
+    }
+    const StrMatcher & matcher( matchers[batch._term] );
+    for ( const sat::Solvable * it = batch._begin; it != batch._end; ++it )
+    {
+      size_t i = 2 * ( it - batch._begin );
+      if ( matcher.doMatch( texts[i].c_str() ) || matcher.doMatch( texts[i+1].c_str() ) )
+	batch._matches.push_back( *it );
+    }
+  } );
+
+  for ( const Batch & batch : batches )
+  {
+    for ( const sat::Solvable & solv : batch._matches )
+    {
+      if ( searchesKind( query, solv ) )
+	result.push_back( solv );
+    }
+  }
+  inPoolOrder( result );
+  MIL << "Found " << result.size() << " solvables matching in summary or description ("
+      << batches.size() << " batches)" << endl;
+}
+
+void search_file_list( Zypper & zypper, const PoolQuery & query,
+                       const std::vector<std::string> & terms,
+                       std::vector<sat::Solvable> & result )
+{
+  // How to look up the paths a term may match in the index. Regex and
+  // fnmatch may fold non-ASCII characters, the index does not; for those
+  // the index is used as a compact file list only.
+  struct FileTerm
+  {
+    std::string _key;
+    SearchIndex::PathLookup _lookup;
+    StrMatcher _matcher;
+  };
+  std::vector<FileTerm> fileTerms;
+  for_( it, terms.begin(), terms.end() )
+  {
+    std::string key( *it );
+    SearchIndex::PathLookup lookup( SearchIndex::PATH_SUBSTRING );
+    std::string pattern( *it );
+    Match flags( Match::SUBSTRING );
+
+    if ( query.matchRegex() )
+    {
+      flags = Match::REGEX;
+      lookup = SearchIndex::PATH_ALL;
+    }
+    else if ( query.matchGlob() )
+    {
+      flags = Match::GLOB;
+      key = it->substr( 0, it->find_first_of( "*?[\\" ) );	// the literal prefix
+      lookup = SearchIndex::PATH_PREFIX;
+    }
+    else if ( query.matchWord() )
+    {
+      // PoolQuery uses words unescaped in a regex, enclosed in word boundaries.
+      flags = Match::REGEX;
+      pattern = "\\b" + *it + "\\b";
+      if ( hasRegexChars( *it ) )
+	lookup = SearchIndex::PATH_ALL;
+    }
+    else if ( query.matchExact() )
+    {
+      flags = Match::STRING;
+      lookup = SearchIndex::PATH_EXACT;
+    }
+
+    if ( ! query.caseSensitive() )
+    {
+      if ( hasNonAscii( *it ) && ( query.matchRegex() || query.matchGlob() || query.matchWord() ) )
+	lookup = SearchIndex::PATH_ALL;
+      flags |= Match::NOCASE;
+    }
+
+    fileTerms.push_back( FileTerm{ key, lookup, StrMatcher( pattern, flags ) } );
+    fileTerms.back()._matcher.compile();
+  }
+
+  SearchRepos repos( zypper, query );
+
+  // Per repo and term. Path index lookups don't need libsolv at all. The
+  // file lists of repos without an index are retrieved with the lock held,
+  // a few solvables at a time, and matched in parallel.
+  std::vector<std::vector<sat::Solvable>> found( repos.size() * fileTerms.size() );
+  std::mutex satLock;
+  parallel_for( found.size(), [&]( unsigned idx_r ) {
+    const SearchIndex & index( repos.index( idx_r / fileTerms.size() ) );
+    const FileTerm & term( fileTerms[idx_r % fileTerms.size()] );
+    std::vector<sat::Solvable> & matches( found[idx_r] );
+    if ( index.fileMatches( term._key, term._lookup, term._matcher, matches ) )
+      return;
+
+    const std::vector<sat::Solvable> & solvables( index.solvables() );
+    std::vector<std::vector<std::string>> files;
+    for ( size_t off = 0; off < solvables.size(); off += 64 )
+    {
+      size_t end = std::min( off + 64, solvables.size() );
+      files.assign( end - off, std::vector<std::string>() );
+      {
+	std::lock_guard<std::mutex> guard( satLock );
+	for ( size_t i = off; i < end; ++i )
+	{
+	  sat::LookupAttr filelist( sat::SolvAttr::filelist, solvables[i] );
+	  for_( fit, filelist.begin(), filelist.end() )
+	    files[i-off].push_back( fit.asString() );
+	}
+      }
+      for ( size_t i = off; i < end; ++i )
+      {
+	for ( const std::string & file : files[i-off] )
+	{
+	  if ( term._matcher.doMatch( file.c_str() ) )
+	  {
+	    matches.push_back( solvables[i] );
+	    break;
+	  }
+	}
+      }
+    }
+  } );
+
+  for ( const std::vector<sat::Solvable> & matches : found )
+  {
+    for ( const sat::Solvable & solv : matches )
+    {
+      if ( searchesKind( query, solv ) )
+	result.push_back( solv );
+    }
+  }
+  inPoolOrder( result );
+  MIL << "Found " << result.size() << " solvables with matching files" << endl;
+}
+
+SearchRanking::SearchRanking( const PoolQuery & query, const std::vector<std::string> & terms )
+: _caseSensitive( query.caseSensitive() )
+{
+  for_( it, terms.begin(), terms.end() )
+  {
+    if ( query.matchGlob() || query.matchRegex() )
+    {
+      Match flags( query.matchGlob() ? Match::GLOB : Match::REGEX );
+      if ( ! _caseSensitive )
+	flags |= Match::NOCASE;
+      _matchers.push_back( StrMatcher( *it, flags ) );
+      _matchers.back().compile();
+    }
+    else
+      _terms.push_back( _caseSensitive ? *it : str::toLower( *it ) );
+  }
+}
+
+unsigned SearchRanking::operator()( const std::string & name, const std::string & summary ) const
+{
+  unsigned rank = 4;
+  if ( ! _terms.empty() )
+  {
+    const std::string & n( _caseSensitive ? name : str::toLower( name ) );
+    for_( it, _terms.begin(), _terms.end() )
+    {
+      if ( n == *it )
+	return 0;
+      if ( str::startsWith( n, *it ) )
+	rank = 1;
+      else if ( rank > 2 && n.find( *it ) != std::string::npos )
+	rank = 2;
+    }
+    if ( rank < 4 )
+      return rank;
+
+    const std::string & s( _caseSensitive ? summary : str::toLower( summary ) );
+    for_( it, _terms.begin(), _terms.end() )
+    {
+      if ( s.find( *it ) != std::string::npos )
+	return 3;
+    }
+  }
+
+  for_( it, _matchers.begin(), _matchers.end() )
+  {
+    if ( it->doMatch( name.c_str() ) )
+      return 2;
+  }
+  for_( it, _matchers.begin(), _matchers.end() )
+  {
+    if ( it->doMatch( summary.c_str() ) )
+      rank = 3;
+  }
+  return rank;
+}
+
+void LimitedSearchResult::keep( unsigned rank, size_t before )
+{
+  SearchResult::container & rows( _result->rows() );
+  if ( rows.size() == before )
+    return;	// filtered by the callback
+
+  Hit hit;
+  hit._rank = rank;
+  hit._seq = _seq++;
+  hit._rows.assign( std::make_move_iterator( rows.begin() + before ), std::make_move_iterator( rows.end() ) );
+  rows.erase( rows.begin() + before, rows.end() );
+  _hits.push_back( std::move( hit ) );
+  std::push_heap( _hits.begin(), _hits.end() );
+
+  if ( _hits.size() > _limit )
+  {
+    std::pop_heap( _hits.begin(), _hits.end() );
+    _hits.pop_back();
+  }
+}
+
+void LimitedSearchResult::finish()
+{
+  std::sort( _hits.begin(), _hits.end() );
+  SearchResult::container & rows( _result->rows() );
+  for ( Hit & hit : _hits )
+    rows.insert( rows.end(), std::make_move_iterator( hit._rows.begin() ), std::make_move_iterator( hit._rows.end() ) );
+  _hits.clear();
+}
+
 // list_what_provides() isn't called any longer, ZypperCommand::WHAT_PROVIDES_e is
 // replaced by Zypper::SEARCH_e with appropriate options (see Zypper.cc, line 919)
 void list_what_provides( Zypper & zypper, const std::string & str )
@@ -748,8 +1102,8 @@ void list_what_provides( Zypper & zypper, const std::string & str )
     res[(*it).ident()].push_back( *it );
   }
   // 2nd follow picklist (available items list prepended by those installed items not identicalAvailable)
-  Table t;
-  FillSearchTableSolvable fsts(t);
+  SearchResult result;
+  FillSearchTableSolvable fsts( result );
   for_( nameit, res.begin(), res.end() )
   {
     const ui::Selectable::Ptr sel( ui::Selectable::get( nameit->first ) );
@@ -773,6 +1127,8 @@ void list_what_provides( Zypper & zypper, const std::string & str )
 	fsts.addPicklistItem( sel, *it );
     }
   }
+  Table t;
+  result.fillTable( t );
   cout << t;
 }
 
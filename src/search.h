@@ -10,26 +10,28 @@
 
 #include <zypp/TriBool.h>
 #include <zypp/PoolQuery.h>
+#include <zypp/base/StrMatcher.h>
 
 #include "Zypper.h"
 #include "Table.h"
+#include "SearchResult.h"
 
 //std::string selectable_search_repo_str(const ui::Selectable & s);
 
 /**
- * Functor for filling search output table in rug style.
+ * Functor for filling the search result with solvables (search --details).
  */
 struct FillSearchTableSolvable
 {
-  // the table used for output
-  Table * _table;
+  // the result to fill
+  SearchResult * _result;
   const GlobalOptions & _gopts;
   /** Aliases of repos specified as --repo */
   std::set<std::string> _repos;
   TriBool _inst_notinst;
 
   FillSearchTableSolvable(
-      Table & table,
+      SearchResult & result,
       TriBool inst_notinst = indeterminate );
 
   /** Add all items within this Selectable */
@@ -41,7 +43,7 @@ struct FillSearchTableSolvable
   /** PoolQuery iterator provides info about matches*/
   bool operator()( const PoolQuery::const_iterator & it ) const;
 
-  /** Helper to add a table row for \a sel's picklist item \c pi
+  /** Helper to add a result row for \a sel's picklist item \c pi
    * \return whether a row was actually added.
    * \note picklist item means that \a pi must not be an installed
    * item in \a sel, if there is an identical available one. The
@@ -50,39 +52,153 @@ struct FillSearchTableSolvable
   bool addPicklistItem( const ui::Selectable::constPtr & sel, const PoolItem & pi ) const;
 };
 
+/**
+ * Functor for filling the search result with selectables.
+ */
 struct FillSearchTableSelectable
 {
-  // the table used for output
-  Table * _table;
+  // the result to fill
+  SearchResult * _result;
   const GlobalOptions & _gopts;
   /** Aliases of repos specified as --repo */
   std::set<std::string> _repos;
   TriBool inst_notinst;
 
   FillSearchTableSelectable(
-      Table & table, TriBool installed_only = indeterminate);
+      SearchResult & result, TriBool installed_only = indeterminate);
 
   bool operator()(const ui::Selectable::constPtr & s) const;
 };
 
 
 /**
- * Functor for filling search output table in rug style.
+ * Functor for filling the search result with patches in rug style.
  */
 struct FillPatchesTable
 {
-  // the table used for output
-  Table * _table;
+  // the result to fill
+  SearchResult * _result;
   const GlobalOptions & _gopts;
   TriBool _inst_notinst;
 
-  FillPatchesTable( Table & table,
+  FillPatchesTable( SearchResult & result,
       TriBool inst_notinst = indeterminate );
 
   bool operator()(const PoolItem & pi) const;
 };
 
 
+/**
+ * Find the solvables whose summary or description matches any of
+ * \a terms, and append them to \a result (in pool order).
+ *
+ * Kinds, repos, installed status filter, match mode and case sensitivity
+ * are taken from \a query, which itself must not search in summary and
+ * description. Candidates are looked up in the repositories' search
+ * indexes where possible (see \ref SearchIndex); the matching is done
+ * by multiple threads.
+ */
+void search_descriptions( Zypper & zypper, const PoolQuery & query,
+                          const std::vector<std::string> & terms,
+                          std::vector<sat::Solvable> & result );
+
+/**
+ * Find the solvables containing a file whose full path matches any of
+ * \a terms, and append them to \a result (in pool order).
+ *
+ * Like \ref search_descriptions, the search parameters are taken from
+ * \a query, which itself must not search in the file list. Repos without
+ * a path index have their file lists scanned.
+ */
+void search_file_list( Zypper & zypper, const PoolQuery & query,
+                       const std::vector<std::string> & terms,
+                       std::vector<sat::Solvable> & result );
+
+///////////////////////////////////////////////////////////////////
+/// \class SearchRanking
+/// \brief Relevance of a search match (for 'search --limit').
+///
+/// Lower is better: 0 - the name equals a search string, 1 - starts
+/// with one, 2 - contains one (for globs and regexes: matches one),
+/// 3 - the summary contains (matches) one, 4 - anything else, like a
+/// match in the description or dependencies.
+///////////////////////////////////////////////////////////////////
+class SearchRanking
+{
+public:
+  SearchRanking( const PoolQuery & query, const std::vector<std::string> & terms );
+
+  unsigned operator()( const std::string & name, const std::string & summary ) const;
+
+  unsigned operator()( sat::Solvable solv ) const
+  { return operator()( solv.name(), solv.lookupStrAttribute( sat::SolvAttr::summary ) ); }
+
+  unsigned operator()( const ui::Selectable::constPtr & sel ) const
+  { return operator()( sel->theObj().satSolvable() ); }
+
+private:
+  bool _caseSensitive;
+  std::vector<std::string> _terms;	//< literal terms (case folded unless _caseSensitive)
+  std::vector<StrMatcher> _matchers;	//< glob or regex terms
+};
+
+///////////////////////////////////////////////////////////////////
+/// \class LimitedSearchResult
+/// \brief Keeps the result rows of the best \c limit matches only.
+///
+/// Each match is added with its rank (see \ref SearchRanking) and a
+/// function adding its rows to the result. The function is not called
+/// at all for matches which can't make it into the result. Among equal
+/// ranks, the match added first wins. A \c limit of \c 0 means no limit;
+/// all rows are added as usual then.
+///////////////////////////////////////////////////////////////////
+class LimitedSearchResult
+{
+public:
+  LimitedSearchResult( SearchResult & result, unsigned limit )
+  : _result( &result ), _limit( limit ), _seq( 0 )
+  {}
+
+  template <class AddRows>
+  void add( unsigned rank, AddRows addRows )
+  {
+    if ( ! _limit )
+      addRows();
+    else if ( _hits.size() < _limit || rank < _hits.front()._rank )
+    {
+      size_t before = _result->size();
+      addRows();
+      keep( rank, before );
+    }
+  }
+
+  /** Whether no further match can make it into the result. */
+  bool full() const
+  { return _limit && _hits.size() == _limit && _hits.front()._rank == 0; }
+
+  /** Put the rows of the kept matches into the result, best first. */
+  void finish();
+
+private:
+  struct Hit
+  {
+    unsigned _rank;
+    unsigned _seq;
+    SearchResult::container _rows;
+
+    bool operator<( const Hit & rhs ) const
+    { return _rank < rhs._rank || ( _rank == rhs._rank && _seq < rhs._seq ); }
+  };
+
+  /** Move the rows added after the first \a before ones into a new hit. */
+  void keep( unsigned rank, size_t before );
+
+  SearchResult * _result;
+  unsigned _limit;
+  unsigned _seq;
+  std::vector<Hit> _hits;	//< heap, worst hit first
+};
+
 /** List all patches with specific info in specified repos */
 void list_patches(Zypper & zypper);
 
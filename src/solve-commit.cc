@@ -7,6 +7,9 @@
 
 #include <iostream>
 #include <sstream>
+#include <unordered_set>
+#include <unordered_map>
+#include <stdlib.h>
 
 #include <zypp/ZYppFactory.h>
 #include <zypp/base/Logger.h>
@@ -15,7 +18,7 @@
 #include <zypp/base/IOStream.h>
 
 #include <zypp/media/MediaException.h>
-#include <zypp/misc/CheckAccessDeleted.h>
+#include <zypp/Package.h>
 
 #include "misc.h"		// confirm_licenses
 #include "repos.h"		// get_repo - used in dist_upgrade
@@ -23,6 +26,8 @@
 #include "utils/prompt.h"	// Continue? and solver problem prompt
 #include "utils/pager.h"	// to view the summary
 #include "Summary.h"
+#include "ParallelDownload.h"
+#include "utils/ProcScanner.h"
 
 #include "solve-commit.h"
 
@@ -420,11 +425,89 @@ ZYppCommitPolicy get_commit_policy( Zypper & zypper )
   return policy;
 }
 
+/** Retrieve the packages to install in parallel before the commit,
+ * if packages are downloaded in advance. The commit then finds them
+ * in the package cache.
+ * \return the retrieved files which are to be removed after the commit
+ * because their repo does not keep packages.
+ */
+static std::vector<Pathname> prefetch_packages( Zypper & zypper, const ZYppCommitPolicy & policy )
+{
+  std::vector<Pathname> ret;
+  if ( policy.dryRun()
+    || ( policy.downloadMode() != DownloadInAdvance && policy.downloadMode() != DownloadOnly ) )
+    return ret;
+
+  ParallelDownload prefetch( zypper );
+  for ( const PoolItem & pi : God->pool() )
+  {
+    if ( pi.status().isToBeInstalled() && isKind<Package>( pi ) )
+      prefetch.add( pi );
+  }
+  prefetch.run( [&]( const PoolItem & pi_r, const Pathname & localfile_r ) {
+    if ( policy.downloadMode() != DownloadOnly && ! pi_r->repoInfo().keepPackages() )
+      ret.push_back( localfile_r );
+  } );
+  return ret;
+}
+
+/** The files of the installed packages about to be removed or replaced.
+ * Collected before the commit, while their file lists are still in the pool
+ * and their directories still exist.
+ *
+ * The kernel reports mapped files by their resolved path, while the rpm
+ * file lists may name them via a symlinked directory (e.g. \c /lib64 on a
+ * usrmerged system). So each file is recorded below its parent directory
+ * resolved by \c realpath, too.
+ */
+static std::unordered_set<std::string> files_of_replaced_packages( Zypper & zypper )
+{
+  std::unordered_set<std::string> ret;
+  const Pathname & root( zypper.globalOpts().root_dir );
+  std::unordered_map<std::string, std::string> resolvedDirs;	// dir in root -> resolved dir or ""
+  for_( it, God->pool().byKindBegin<Package>(), God->pool().byKindEnd<Package>() )
+  {
+    if ( ! ( it->status().isInstalled() && it->status().isToBeUninstalled() ) )
+      continue;
+    for ( const auto & file : (*it)->asKind<Package>()->filelist() )
+    {
+      Pathname path( Pathname::assertprefix( root, file ) );
+      ret.insert( path.asString() );
+
+      std::string dir( path.dirname().asString() );
+      auto cached( resolvedDirs.find( dir ) );
+      if ( cached == resolvedDirs.end() )
+      {
+	std::string resolved;
+	char * real = ::realpath( dir.c_str(), NULL );
+	if ( real )
+	{
+	  // an absolute symlink in a --root would resolve outside of it
+	  if ( root.emptyOrRoot() || Pathname( real ).asString().compare( 0, root.asString().size() + 1, root.asString() + "/" ) == 0 )
+	    resolved = real;
+	  ::free( real );
+	}
+	if ( resolved == dir )
+	  resolved.clear();	// nothing to add
+	cached = resolvedDirs.insert( std::make_pair( dir, resolved ) ).first;
+      }
+      if ( ! cached->second.empty() )
+	ret.insert( ( Pathname( cached->second ) / path.basename() ).asString() );
+    }
+  }
+  MIL << "Post commit check will look for " << ret.size() << " replaced files" << endl;
+  return ret;
+}
+
 /** fate #300763
  * This is called after each commit to notify user about running processes that
  * use libraries or other files that have been removed since their execution.
+ *
+ * If \a replacedFiles_r is not empty, only mappings of these files are checked
+ * (see \ref files_of_replaced_packages). Otherwise all processes are checked
+ * for any deleted files like 'zypper ps' does.
  */
-static void notify_processes_using_deleted_files( Zypper & zypper )
+static void notify_processes_using_deleted_files( Zypper & zypper, const std::unordered_set<std::string> & replacedFiles_r )
 {
   if ( ! zypper.config().psCheckAccessDeleted )
   {
@@ -434,10 +517,13 @@ static void notify_processes_using_deleted_files( Zypper & zypper )
   }
 
   zypper.out().info(_("Checking for running processes using deleted libraries..."), Out::HIGH );
-  CheckAccessDeleted checker( false ); // wait for explicit call to check()
+  ProcScanner checker;
   try
   {
-    checker.check();
+    if ( replacedFiles_r.empty() )
+      checker.scan();
+    else
+      checker.scan( [&replacedFiles_r]( const std::string & file_r ) { return replacedFiles_r.count( file_r ) != 0; } );
   }
   catch( const Exception & e )
   {
@@ -446,7 +532,7 @@ static void notify_processes_using_deleted_files( Zypper & zypper )
   }
 
   // Don't suggest "zypper ps" if zypper is the only prog with deleted open files.
-  if ( checker.size() > 1 || ( checker.size() == 1 && checker.begin()->pid != str::numstring(::getpid()) ) )
+  if ( checker.size() > 1 || ( checker.size() == 1 && checker.begin()->pid != ::getpid() ) )
   {
     zypper.out().info(str::form(
         _("There are some running programs that might use files deleted by recent upgrade."
@@ -748,6 +834,12 @@ void solve_and_commit ( Zypper & zypper )
           return;
 	}
 
+	// files to look for in the post commit check (fate #300763)
+	std::unordered_set<std::string> replacedFiles;
+	if ( zypper.config().psCheckAccessDeleted
+	  && ! ( zypper.cOpts().count("download-only") || zypper.cOpts().count("dry-run") ) )
+	  replacedFiles = files_of_replaced_packages( zypper );
+
         try
         {
           RuntimeData & gData = Zypper::instance()->runtimeData();
@@ -761,6 +853,14 @@ void solve_and_commit ( Zypper & zypper )
           gData.rpm_pkg_current = 0;
 	  gData.entered_commit = true;	// bsc#946750 - give ZYPPER_EXIT_ERR_COMMIT priority over ZYPPER_EXIT_ON_SIGNAL
 
+	  ZYppCommitPolicy policy( get_commit_policy( zypper ) );
+	  std::vector<Pathname> prefetched( prefetch_packages( zypper, policy ) );
+	  if ( zypper.exitRequested() )
+	  {
+	    zypper.setExitCode( ZYPPER_EXIT_ON_SIGNAL );
+	    return;
+	  }
+
 	  MIL << "committing..." << endl;
 	  if ( zypper.out().verbosity() >= Out::HIGH )
 	  {
@@ -771,7 +871,12 @@ void solve_and_commit ( Zypper & zypper )
 	    zypper.out().info( s.str(), Out::HIGH );
 	  }
 
-          ZYppCommitResult result = God->commit( get_commit_policy( zypper ) );
+          ZYppCommitResult result = God->commit( policy );
+	  for ( const Pathname & localfile : prefetched )
+	  {
+	    if ( PathInfo( localfile ).isFile() )
+	      filesystem::unlink( localfile );
+	  }
           gData.show_media_progress_hack = false;
 	  gData.entered_commit = false;
 
@@ -888,7 +993,7 @@ void solve_and_commit ( Zypper & zypper )
         if ( ! ( zypper.cOpts().count("download-only") || zypper.cOpts().count("dry-run") )
 	  && ( summary.packagesToRemove() || summary.packagesToUpgrade() || summary.packagesToDowngrade() ) )
 	{
-          notify_processes_using_deleted_files( zypper );
+          notify_processes_using_deleted_files( zypper, replacedFiles );
 	}
       }
     }
@@ -6,6 +6,15 @@
 \*---------------------------------------------------------------------------*/
 
 #include <iostream>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <system_error>
+#include <future>
+#include <unistd.h>
 
 #include <zypp/base/LogTools.h>
 #include <zypp/ResPool.h>
@@ -18,6 +27,7 @@
 #include "Zypper.h"
 #include "Table.h"
 #include "source-download.h"
+#include "ParallelDownload.h"
 
 ///////////////////////////////////////////////////////////////////
 // SourceDownloadOptions
@@ -25,6 +35,7 @@
 
 const Pathname SourceDownloadOptions::_defaultDirectory( "/var/cache/zypper/source-download" );
 const std::string SourceDownloadOptions::_manifestName( "MANIFEST" );
+const std::string SourceDownloadOptions::_headerIndexName( ".MANIFEST.index" );
 
 inline std::ostream & operator<<( std::ostream & str, const SourceDownloadOptions & obj )
 {
@@ -38,6 +49,351 @@ inline std::ostream & operator<<( std::ostream & str, const SourceDownloadOption
 ///////////////////////////////////////////////////////////////////
 namespace
 {
+  ///////////////////////////////////////////////////////////////////
+  /// \class HeaderIndex
+  /// \brief Header data (name, edition, nosrc) of the files in a download directory.
+  ///
+  /// Persistent cache, so a directory scan needs to read the headers of new
+  /// or changed files only. Entries are keyed by file name and validated by
+  /// inode, size and mtime.
+  ///
+  /// Changed files are read by multiple threads using a minimal lead/header
+  /// parser. Neither librpm (via RpmHeader) nor our logging are thread safe.
+  /// Files the parser does not understand are passed to RpmHeader::readPackage.
+  ///////////////////////////////////////////////////////////////////
+  class HeaderIndex
+  {
+  public:
+    struct Entry
+    {
+      Entry()
+      : _ino( 0 ), _size( 0 ), _mtime( 0 ), _type( '-' )
+      {}
+
+      bool isSrc() const
+      { return _type != '-'; }
+
+      bool isNosrc() const
+      { return _type == 'n'; }
+
+      bool sameFile( const PathInfo & pi_r ) const
+      { return _ino == pi_r.ino() && _size == pi_r.size() && _mtime == pi_r.mtime(); }
+
+      ino_t _ino;
+      off_t _size;
+      time_t _mtime;
+      char _type;		//< 's': src, 'n': nosrc, '-': no source package
+      std::string _name;
+      std::string _edition;	//< as string; Edition is not thread safe to create
+    };
+    typedef std::map<std::string,Entry> Entries;
+
+  public:
+    /** Load the index stored in \a file_r (if any). */
+    HeaderIndex( const Pathname & file_r )
+    : _file( file_r )
+    , _dirty( false )
+    { load(); }
+
+    /** Update the index to contain exactly \a files_r in \a dir_r. */
+    void update( const Pathname & dir_r, const std::list<std::string> & files_r, Out::ProgressBar & report_r );
+
+    /** Write the index back if it changed; silently ignore failures. */
+    void save();
+
+    const Entries & entries() const
+    { return _entries; }
+
+  private:
+    enum ReadResult { R_OK, R_NOT_RPM, R_UNKNOWN };
+
+    /** Thread safe minimal header reader. */
+    static ReadResult readHeader( const Pathname & path_r, Entry & entry_r );
+
+    void load();
+
+  private:
+    Pathname _file;
+    Entries _entries;
+    bool _dirty;
+  };
+
+  void HeaderIndex::load()
+  {
+    std::ifstream in( _file.c_str() );
+    if ( ! in )
+      return;
+
+    std::string line;
+    if ( ! std::getline( in, line ) || line != "# zypper source-download index 1" )
+    {
+      WAR << "Ignoring header index " << _file << " (unknown format)" << endl;
+      _dirty = true;
+      return;
+    }
+
+    // <file>\t<ino>\t<size>\t<mtime>\t<type>\t<name>\t<edition>
+    while ( std::getline( in, line ) )
+    {
+      std::vector<std::string> words;
+      str::split( line, std::back_inserter( words ), "\t" );
+      if ( words.size() != 7 || words[4].size() != 1 )
+      {
+	_dirty = true;	// rewrite it
+	continue;
+      }
+      Entry & entry( _entries[words[0]] );
+      entry._ino   = str::strtonum<ino_t>( words[1] );
+      entry._size  = str::strtonum<off_t>( words[2] );
+      entry._mtime = str::strtonum<time_t>( words[3] );
+      entry._type  = words[4][0];
+      entry._name  = words[5];
+      entry._edition = words[6];
+    }
+    DBG << "Loaded " << _entries.size() << " entries from " << _file << endl;
+  }
+
+  void HeaderIndex::save()
+  {
+    if ( ! _dirty )
+      return;
+
+    Pathname tmpfile( _file.extend( ".new" ) );
+    {
+      std::ofstream out( tmpfile.c_str() );
+      if ( ! out )
+      {
+	WAR << "Can't write header index " << tmpfile << endl;
+	return;
+      }
+      out << "# zypper source-download index 1" << endl;
+      for ( const auto & ent : _entries )
+      {
+	if ( ent.first.find_first_of( "\t\n" ) != std::string::npos )
+	  continue;	// would break the index file; read again next time
+	const Entry & entry( ent.second );
+	out << ent.first << '\t' << entry._ino << '\t' << entry._size << '\t' << entry._mtime
+	    << '\t' << entry._type << '\t' << entry._name << '\t' << entry._edition << '\n';
+      }
+      if ( ! out.flush() )
+      {
+	WAR << "Can't write header index " << tmpfile << endl;
+	filesystem::unlink( tmpfile );
+	return;
+      }
+    }
+    if ( filesystem::rename( tmpfile, _file ) == 0 )
+    {
+      _dirty = false;
+      MIL << "Saved " << _entries.size() << " entries to " << _file << endl;
+    }
+    else
+      filesystem::unlink( tmpfile );
+  }
+
+  inline uint32_t be32( const unsigned char * p )
+  { return ( uint32_t(p[0]) << 24 ) | ( uint32_t(p[1]) << 16 ) | ( uint32_t(p[2]) << 8 ) | uint32_t(p[3]); }
+
+  HeaderIndex::ReadResult HeaderIndex::readHeader( const Pathname & path_r, Entry & entry_r )
+  {
+    // NOTE: Runs in worker threads - no logging here!
+    std::ifstream in( path_r.c_str(), std::ios::binary );
+    unsigned char lead[96];
+    if ( ! in.read( (char*)lead, sizeof(lead) ) || be32( lead ) != 0xedabeedb )
+      return R_NOT_RPM;
+    bool leadIsSrc = ( lead[6] == 0 && lead[7] == 1 );
+
+    // skip the signature header (padded to 8 bytes)
+    unsigned char intro[16];
+    if ( ! in.read( (char*)intro, sizeof(intro) ) || be32( intro ) != 0x8eade801 )
+      return R_UNKNOWN;
+    uint64_t il = be32( intro+8 );
+    uint64_t dl = be32( intro+12 );
+    if ( il > 0x10000 || dl > 0x10000000 )
+      return R_UNKNOWN;
+    uint64_t sigsize = sizeof(intro) + il*16 + dl;
+    sigsize += ( 8 - sigsize % 8 ) % 8;
+
+    // main header
+    if ( ! in.seekg( sizeof(lead) + sigsize )
+      || ! in.read( (char*)intro, sizeof(intro) ) || be32( intro ) != 0x8eade801 )
+      return R_UNKNOWN;
+    il = be32( intro+8 );
+    dl = be32( intro+12 );
+    if ( il > 0x10000 || dl > 0x10000000 )
+      return R_UNKNOWN;
+    std::vector<unsigned char> buf( il*16 + dl );
+    if ( buf.empty() || ! in.read( (char*)&buf[0], buf.size() ) )
+      return R_UNKNOWN;
+    const unsigned char * store = &buf[il*16];
+
+    auto stringAt = [&]( uint32_t offset_r ) -> std::string {
+      if ( offset_r >= dl )
+	return std::string();
+      const void * end = ::memchr( store + offset_r, '\0', dl - offset_r );
+      return end ? std::string( (const char *)store + offset_r, (const char *)end ) : std::string();
+    };
+
+    std::string version;
+    std::string release;
+    uint32_t epoch = 0;
+    bool sourcepackage = false;
+    bool sourcerpm = false;
+    bool nosrc = false;
+    entry_r._name.clear();
+    for ( uint64_t i = 0; i < il; ++i )
+    {
+      const unsigned char * idx = &buf[i*16];
+      uint32_t tag = be32( idx );
+      uint32_t type = be32( idx+4 );
+      uint32_t offset = be32( idx+8 );
+      switch ( tag )
+      {
+	case 1000:	// RPMTAG_NAME
+	  if ( type == 6 ) entry_r._name = stringAt( offset );
+	  break;
+	case 1001:	// RPMTAG_VERSION
+	  if ( type == 6 ) version = stringAt( offset );
+	  break;
+	case 1002:	// RPMTAG_RELEASE
+	  if ( type == 6 ) release = stringAt( offset );
+	  break;
+	case 1003:	// RPMTAG_EPOCH
+	  if ( type == 4 && offset + 4 <= dl ) epoch = be32( store + offset );
+	  break;
+	case 1044:	// RPMTAG_SOURCERPM
+	  sourcerpm = true;
+	  break;
+	case 1051:	// RPMTAG_NOSOURCE
+	case 1052:	// RPMTAG_NOPATCH
+	  nosrc = true;
+	  break;
+	case 1106:	// RPMTAG_SOURCEPACKAGE
+	  sourcepackage = true;
+	  break;
+      }
+    }
+    if ( entry_r._name.empty() || version.empty() || release.empty() )
+      return R_UNKNOWN;
+
+    // same as Edition( version, release, epoch ).asString()
+    entry_r._edition = ( epoch ? str::numstring( epoch ) + ":" : std::string() ) + version + "-" + release;
+    if ( sourcepackage || ( leadIsSrc && ! sourcerpm ) )
+      entry_r._type = nosrc ? 'n' : 's';
+    else
+      entry_r._type = '-';
+    return R_OK;
+  }
+
+  void HeaderIndex::update( const Pathname & dir_r, const std::list<std::string> & files_r, Out::ProgressBar & report_r )
+  {
+    report_r->range( files_r.size() );
+
+    // Collect new and changed files. Everything else is up to date.
+    Entries entries;
+    std::vector<std::pair<std::string,Entry>> todo;
+    for ( const auto & file : files_r )
+    {
+      PathInfo pi( dir_r / file );
+      if ( ! pi.isFile() )
+	continue;
+
+      Entries::iterator it( _entries.find( file ) );
+      if ( it != _entries.end() && it->second.sameFile( pi ) )
+      {
+	entries.insert( *it );
+	report_r->incr();
+	continue;
+      }
+
+      Entry entry;
+      entry._ino = pi.ino();
+      entry._size = pi.size();
+      entry._mtime = pi.mtime();
+      todo.push_back( std::make_pair( file, entry ) );
+    }
+    _dirty = _dirty || ! todo.empty() || entries.size() != _entries.size();
+    MIL << "Header index: " << entries.size() << " up to date, " << todo.size() << " to read" << endl;
+
+    // Read the headers of the todo list in parallel.
+    std::vector<ReadResult> results( todo.size(), R_UNKNOWN );
+    if ( ! todo.empty() )
+    {
+      std::atomic<unsigned> next( 0 );
+      std::atomic<unsigned> done( 0 );
+      auto work = [&]() {
+	for ( unsigned i = next++; i < todo.size(); i = next++ )
+	{
+	  results[i] = readHeader( dir_r / todo[i].first, todo[i].second );
+	  ++done;
+	}
+      };
+
+      unsigned nthreads = std::min( std::max( std::thread::hardware_concurrency(), 1U ), 8U );
+      if ( todo.size() < 32 )
+	nthreads = 1;
+      std::vector<std::thread> threads;
+      for ( unsigned i = 1; i < nthreads; ++i )
+      {
+	try { threads.push_back( std::thread( work ) ); }
+	catch ( const std::system_error & ) { break; }	// fewer threads then
+      }
+      if ( threads.empty() )
+	work();
+      else
+      {
+	unsigned base = report_r->val();
+	while ( done < todo.size() )
+	{
+	  report_r->set( base + done );
+	  std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+	}
+	for ( auto & thread : threads )
+	  thread.join();
+      }
+    }
+
+    for ( unsigned i = 0; i < todo.size(); ++i )
+    {
+      Entry & entry( todo[i].second );
+      if ( results[i] == R_UNKNOWN )
+      {
+	// let librpm try
+	using target::rpm::RpmHeader;
+	RpmHeader::constPtr pkg( RpmHeader::readPackage( dir_r / todo[i].first, RpmHeader::NOVERIFY ) );
+	if ( pkg )
+	{
+	  entry._name = pkg->tag_name();
+	  entry._edition = pkg->tag_edition().asString();
+	  entry._type = pkg->isSrc() ? ( pkg->isNosrc() ? 'n' : 's' ) : '-';
+	}
+	else
+	  entry._type = '-';
+      }
+      else if ( results[i] == R_NOT_RPM )
+	entry._type = '-';
+
+      entries.insert( std::move( todo[i] ) );
+    }
+    report_r->set( files_r.size() );
+    _entries.swap( entries );
+  }
+
+  /** Copy a downloaded srpm to \a dir_r/\a name_r.
+   * The file is copied to a hidden temp file and renamed, so an interrupted
+   * run does not leave an incomplete srpm behind.
+   */
+  int installSrcFile( const Pathname & localfile_r, const Pathname & dir_r, const std::string & name_r )
+  {
+    Pathname part( dir_r / ( "." + name_r + ".part" ) );
+    filesystem::unlink( part );
+    int res = filesystem::hardlinkCopy( localfile_r, part );
+    if ( res == 0 )
+      res = filesystem::rename( part, dir_r / name_r );
+    if ( res != 0 )
+      filesystem::unlink( part );
+    return res;
+  }
 
   ///////////////////////////////////////////////////////////////////
   /// \class SourceDownloadImpl
@@ -150,6 +506,9 @@ namespace
     /** Startup and build manifest. */
     void buildManifest();
 
+    /** Download \ref SourcePkg::S_MISSING packages in parallel. */
+    void prefetchMissing();
+
     std::ostream & dumpManifestSumary( std::ostream & str, Manifest::StatusMap & status );
     std::ostream & dumpManifestTable( std::ostream & str );
 
@@ -233,24 +592,25 @@ namespace
 	return;
       }
 
-      Out::ProgressBar report( _zypper.out(), _("Scanning download directory") );
-      report->range( todolist.size() );
-      for ( const auto & file : todolist )
-      {
-	report->incr();	// fast enough to count in advance.
-
-	if ( file == _options->_manifestName )
-	  continue;
+      todolist.remove( _options->_manifestName );
+      todolist.remove( _options->_headerIndexName );
 
-	using target::rpm::RpmHeader;
-	Pathname path( pi.path() / file );
-	RpmHeader::constPtr pkg( RpmHeader::readPackage( path, RpmHeader::NOVERIFY ) );
+      HeaderIndex index( pi.path() / _options->_headerIndexName );
+      {
+	Out::ProgressBar report( _zypper.out(), _("Scanning download directory") );
+	index.update( pi.path(), todolist, report );
+      }
+      if ( pi.userMayW() )
+	index.save();
 
-	if ( ! ( pkg && pkg->isSrc() ) )
+      for ( const auto & ent : index.entries() )
+      {
+	const HeaderIndex::Entry & entry( ent.second );
+	if ( ! entry.isSrc() )
 	  continue;
 
-	SourcePkg & spkg( _manifest.get( SourcePkg::makeLongname( pkg->tag_name(), pkg->tag_edition(), pkg->isNosrc() ) ) );
-	spkg._localFile = file;
+	SourcePkg & spkg( _manifest.get( SourcePkg::makeLongname( entry._name, Edition( entry._edition ), entry.isNosrc() ) ) );
+	spkg._localFile = ent.first;
       }
     }
 
@@ -372,29 +732,34 @@ namespace
       return;	// --> dry run ends here.
     }
 
-    // delete superfluous source packages
+    // delete superfluous source packages (in the background)
 
+    std::vector<SourcePkg *> superfluous;
+    std::future<std::vector<int>> deleted;	// errno per superfluous file
     if ( status[SourcePkg::S_SUPERFLUOUS] && _options->_delete )
     {
-      Out::ProgressBar report( _zypper.out(), _("Deleting superfluous source packages") );
-      report->range( status[SourcePkg::S_SUPERFLUOUS] );
+      std::vector<Pathname> files;
       for ( auto & item : _manifest )
       {
 	SourcePkg & spkg( item.second );
 	if ( spkg.status() != SourcePkg::S_SUPERFLUOUS )
 	  continue;
-
-	int res = filesystem::unlink( _dnlDir / spkg._localFile );
-	if ( res != 0 )
-	{
-	  throw( Out::Error( str::Format(_("Failed to remove source package '%s'")) % (_dnlDir / spkg._localFile),
-			     Errno().asString() ) );
-	}
-	MIL << spkg << endl;
-	spkg._localFile.clear();
-	DBG << spkg << endl;
-	report->incr();
+	superfluous.push_back( &spkg );
+	files.push_back( _dnlDir / spkg._localFile );
       }
+
+      // NOTE: plain ::unlink; filesystem::unlink logs and logging is not thread safe.
+      auto unlinkAll = [files]() {
+	std::vector<int> ret;
+	ret.reserve( files.size() );
+	for ( const Pathname & file : files )
+	  ret.push_back( ::unlink( file.c_str() ) == 0 ? 0 : errno );
+	return ret;
+      };
+      try
+      { deleted = std::async( std::launch::async, unlinkAll ); }
+      catch ( const std::system_error & )
+      { deleted = std::async( std::launch::deferred, unlinkAll ); }
     }
     else
     {
@@ -409,6 +774,16 @@ namespace
     if ( status[SourcePkg::S_MISSING] )
     {
       _zypper.out().info(_("Downloading required source packages...") );
+      prefetchMissing();
+      _manifest.updateStatus( status );
+    }
+    else
+    {
+      _zypper.out().info(_("No source packages to download.") );
+    }
+
+    if ( status[SourcePkg::S_MISSING] )	// not retrieved in parallel
+    {
       repo::RepoMediaAccess access;
       repo::SrcPackageProvider prov( access );
       unsigned current = 0;
@@ -441,7 +816,7 @@ namespace
 	    report.error( false );
 	  }
 
-	  if ( filesystem::hardlinkCopy( localfile, _dnlDir / (spkg._longname+".rpm") ) != 0 )
+	  if ( installSrcFile( localfile, _dnlDir, spkg._longname+".rpm" ) != 0 )
 	  {
 	    ERR << "Can't hardlink/copy " << localfile << " to " <<  (_dnlDir / spkg._longname) << endl;
 	    report.error();
@@ -469,12 +844,80 @@ namespace
 	  throw( Out::Error( ZYPPER_EXIT_ON_SIGNAL ) );
       }
     }
-    else
+
+    // collect the deleted superfluous source packages
+
+    if ( deleted.valid() )
     {
-      _zypper.out().info(_("No source packages to download.") );
+      Out::ProgressBar report( _zypper.out(), _("Deleting superfluous source packages") );
+      report->range( superfluous.size() );
+      std::vector<int> errors( deleted.get() );
+      for ( unsigned i = 0; i < superfluous.size(); ++i )
+      {
+	SourcePkg & spkg( *superfluous[i] );
+	if ( errors[i] != 0 )
+	{
+	  report.error();
+	  throw( Out::Error( str::Format(_("Failed to remove source package '%s'")) % (_dnlDir / spkg._localFile),
+			     Errno( errors[i] ).asString() ) );
+	}
+	MIL << spkg << endl;
+	spkg._localFile.clear();
+	DBG << spkg << endl;
+	report->incr();
+      }
     }
   }
 
+  void SourceDownloadImpl::prefetchMissing()
+  {
+    std::map<sat::Solvable, SourcePkg *> jobs;
+    for ( auto & item : _manifest )
+    {
+      SourcePkg & spkg( item.second );
+      if ( spkg.status() == SourcePkg::S_MISSING && spkg.lookupSrcPackage() )
+	jobs[spkg._srcPackage.satSolvable()] = &spkg;
+    }
+    if ( jobs.size() < 2 )
+      return;
+
+    // file names to use; passed to the worker processes
+    std::map<sat::Solvable, std::string> names;
+    for ( const auto & job : jobs )
+      names[job.first] = job.second->_longname + ".rpm";
+    Pathname dnlDir( _dnlDir );
+
+    // Media access and provider are created in each worker on demand.
+    shared_ptr<repo::RepoMediaAccess> access;
+    shared_ptr<repo::SrcPackageProvider> prov;
+    ParallelDownload prefetch( _zypper, [=]( const PoolItem & pi_r ) mutable -> Pathname {
+      if ( ! prov )
+      {
+	access.reset( new repo::RepoMediaAccess );
+	prov.reset( new repo::SrcPackageProvider( *access ) );
+      }
+      ManagedFile localfile( prov->provideSrcPackage( pi_r->asKind<SrcPackage>() ) );
+      const std::string & name( names.find( pi_r.satSolvable() )->second );
+      if ( installSrcFile( localfile, dnlDir, name ) != 0 )
+	ZYPP_THROW( Exception( "Can't hardlink/copy " + localfile->asString() + " to " + dnlDir.asString() ) );
+      return dnlDir / name;
+    } );
+
+    for ( const auto & job : jobs )
+      prefetch.add( job.second->_srcPackage );
+
+    // Completed packages are found in the download directory on restart;
+    // the rest is left to the serial code path.
+    prefetch.run( [&]( const PoolItem & pi_r, const Pathname & localfile_r ) {
+      SourcePkg & spkg( *jobs[pi_r.satSolvable()] );
+      spkg._localFile = localfile_r.basename();
+      MIL << spkg << endl;
+    } );
+
+    if ( _zypper.exitRequested() )
+      throw( Out::Error( ZYPPER_EXIT_ON_SIGNAL ) );
+  }
+
 } // namespace
 ///////////////////////////////////////////////////////////////////
 
@@ -36,6 +36,7 @@ struct SourceDownloadOptions : public Options
 {
   static const Pathname _defaultDirectory;
   static const std::string _manifestName;
+  static const std::string _headerIndexName;
 
   SourceDownloadOptions()
     : Options( ZypperCommand::SOURCE_DOWNLOAD )
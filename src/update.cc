@@ -1,5 +1,6 @@
 #include <iostream> // for xml and table output
 #include <sstream>
+#include <algorithm>
 
 #include <zypp/base/LogTools.h>
 #include <zypp/ZYppFactory.h>
@@ -11,6 +12,10 @@
 #include "SolverRequester.h"
 #include "Table.h"
 #include "update.h"
+#include "PatchIssueIndex.h"
+#include "output/XmlWriter.h"
+#include "output/JsonObject.h"
+#include "output/OutJSON.h"
 #include "main.h"
 
 using namespace zypp;
@@ -20,27 +25,6 @@ extern ZYpp::Ptr God;
 
 static void find_updates( const ResKindSet & kinds, Candidates & candidates );
 
-///////////////////////////////////////////////////////////////////
-/// \class Issues
-/// \brief An issue (Type,Id) pair
-///////////////////////////////////////////////////////////////////
-struct Issue : std::pair<std::string, std::string>
-{
-  Issue( std::string issueType_r, std::string issueId_r )
-  : std::pair<std::string, std::string>( std::move(issueType_r), std::move(issueId_r) )
-  {}
-
-  std::string &       type()			{ return first; }
-  const std::string & type()		const	{ return first; }
-  bool                anyType()		const	{ return type().empty(); }
-  bool                specificType()	const	{ return !anyType(); }
-
-  std::string &       id()			{ return second; }
-  const std::string & id()		const	{ return second; }
-  bool                anyId()		const 	{ return id().empty(); }
-  bool                specificId()	const	{ return !anyId(); }
-};
-
 ///////////////////////////////////////////////////////////////////
 /// \class CliScanIssues
 /// \brief Setup issue (Type,Id) pairs from CLI
@@ -54,6 +38,7 @@ struct CliScanIssues : public std::set<Issue>
     checkCLI( "bugzilla", "bugzilla" );
     checkCLI( "bz",       "bugzilla" );
     checkCLI( "cve",      "cve" );
+    checkFile( "issue-file" );
   }
 
 private:
@@ -87,8 +72,40 @@ private:
       { insert( value_type( issueType_r, std::move(val) ) ); }
     }
   }
-};
 
+  /** Each line in the file is either '<id>' or '<type> <id>'. */
+  void checkFile( const std::string & cliOption_r )
+  {
+    Zypper & zypper( *Zypper::instance() );
+
+    for ( const auto & val : zypper.cOptValues( cliOption_r ) )
+    {
+      std::vector<std::string> lines;
+      if ( ! read_list_file( val.to_string(), lines ) )
+      {
+	zypper.setExitCode( ZYPPER_EXIT_ERR_INVALID_ARGS );
+	ZYPP_THROW( ExitRequestException("Unreadable --issue-file") );
+      }
+
+      for ( const std::string & line : lines )
+      {
+	std::vector<std::string> words;
+	switch ( str::split( line, std::back_inserter(words) ) )
+	{
+	  case 1:
+	    insert( value_type( std::string(), std::move(words[0]), /*exact*/true ) );
+	    break;
+	  case 2:
+	    insert( value_type( std::move(words[0]), std::move(words[1]), /*exact*/true ) );
+	    break;
+	  default:
+	    zypper.out().warning( str::Format(_("Ignoring malformed line '%s' in %s.")) % line % val );
+	    break;
+	}
+      }
+    }
+  }
+};
 
 std::string patchHighlight( std::string && val_r )
 {
@@ -224,40 +241,44 @@ inline const char *const xml_patchStatusAsString( const PoolItem & pi_r )
   return "undetermined";
 }
 
-static void xml_print_patch( Zypper & zypper, const PoolItem & pi )
+/** Interactive flags of patches not to consider when updating. */
+static Patch::InteractiveFlags ignoredInteractiveFlags( Zypper & zypper )
 {
-  Patch::constPtr patch = pi->asKind<Patch>();
-
-  cout << " <update ";
-  cout << "name=\"" << patch->name () << "\" ";
-  cout << "edition=\""  << patch->edition() << "\" ";
-  cout << "arch=\""  << patch->arch() << "\" ";
-  cout << "status=\""  << xml_patchStatusAsString( pi ) << "\" ";
-  cout << "category=\"" <<  patch->category() << "\" ";
-  cout << "severity=\"" <<  patch->severity() << "\" ";
-  cout << "pkgmanager=\"" << (patch->restartSuggested() ? "true" : "false") << "\" ";
-  cout << "restart=\"" << (patch->rebootSuggested() ? "true" : "false") << "\" ";
-
   Patch::InteractiveFlags ignoreFlags = Patch::NoFlags;
   if (zypper.globalOpts().reboot_req_non_interactive)
     ignoreFlags |= Patch::Reboot;
   if ( zypper.cOpts().count("auto-agree-with-licenses") || zypper.cOpts().count("agree-to-third-party-licenses") )
     ignoreFlags |= Patch::License;
+  return ignoreFlags;
+}
 
-  cout << "interactive=\"" << (patch->interactiveWhenIgnoring(ignoreFlags) ? "true" : "false") << "\" ";
-  cout << "kind=\"patch\"";
-  cout << ">" << endl;
-  cout << "  <summary>" << xml::escape(patch->summary()) << "  </summary>" << endl;
-  cout << "  <description>" << xml::escape(patch->description()) << "</description>" << endl;
-  cout << "  <license>" << xml::escape(patch->licenseToConfirm()) << "</license>" << endl;
+static void xml_print_patch( Zypper & zypper, XmlWriter & xml, const PoolItem & pi )
+{
+  Patch::constPtr patch = pi->asKind<Patch>();
+
+  xml << " <update ";
+  xml << "name=\"" << patch->name () << "\" ";
+  xml << "edition=\""  << patch->edition() << "\" ";
+  xml << "arch=\""  << patch->arch() << "\" ";
+  xml << "status=\""  << xml_patchStatusAsString( pi ) << "\" ";
+  xml << "category=\"" <<  patch->category() << "\" ";
+  xml << "severity=\"" <<  patch->severity() << "\" ";
+  xml << "pkgmanager=\"" << (patch->restartSuggested() ? "true" : "false") << "\" ";
+  xml << "restart=\"" << (patch->rebootSuggested() ? "true" : "false") << "\" ";
+  xml << "interactive=\"" << (patch->interactiveWhenIgnoring(ignoredInteractiveFlags( zypper )) ? "true" : "false") << "\" ";
+  xml << "kind=\"patch\"";
+  xml << ">\n";
+  xml << "  <summary>" << XmlWriter::Text(patch->summary()) << "  </summary>\n";
+  xml << "  <description>" << XmlWriter::Text(patch->description()) << "</description>\n";
+  xml << "  <license>" << XmlWriter::Text(patch->licenseToConfirm()) << "</license>\n";
 
   if ( !patch->repoInfo().alias().empty() )
   {
-    cout << "  <source url=\"" << xml::escape(patch->repoInfo().url().asString());
-    cout << "\" alias=\"" << xml::escape(patch->repoInfo().alias()) << "\"/>" << endl;
+    xml << "  <source url=\"" << XmlWriter::Text(patch->repoInfo().url().asString());
+    xml << "\" alias=\"" << XmlWriter::Text(patch->repoInfo().alias()) << "\"/>\n";
   }
 
-  cout << " </update>" << endl;
+  xml << " </update>\n";
 }
 
 
@@ -265,6 +286,7 @@ static void xml_print_patch( Zypper & zypper, const PoolItem & pi )
 static bool xml_list_patches (Zypper & zypper)
 {
   const ResPool& pool = God->pool();
+  XmlWriter xml( cout );
 
   // check whether there are packages affecting the update stack
   bool pkg_mgr_available = false;
@@ -291,7 +313,7 @@ static bool xml_list_patches (Zypper & zypper)
       // if updates stack patches are available, show only those
       if ( all || !pkg_mgr_available || patch->restartSuggested() )
       {
-	xml_print_patch( zypper, pi );
+	xml_print_patch( zypper, xml, pi );
       }
     }
     ++patchcount;
@@ -299,16 +321,16 @@ static bool xml_list_patches (Zypper & zypper)
 
   //! \todo change this from appletinfo to something general, define in xmlout.rnc
   if (patchcount == 0)
-    cout << "<appletinfo status=\"no-update-repositories\"/>" << endl;
+    xml << "<appletinfo status=\"no-update-repositories\"/>\n";
 
 
   if ( pkg_mgr_available )
   {
     // close <update-list> and write <blocked-update-list> if not all
-    cout << "</update-list>" << endl;
+    xml << "</update-list>\n";
     if ( ! all )
     {
-    cout << "<blocked-update-list>" << endl;
+    xml << "<blocked-update-list>\n";
     for_( it, pool.byKindBegin(ResKind::patch), pool.byKindEnd(ResKind::patch) )
     {
       if ( patchIsApplicable( *it ) )
@@ -316,10 +338,10 @@ static bool xml_list_patches (Zypper & zypper)
 	const PoolItem & pi( *it );
 	Patch::constPtr patch = pi->asKind<Patch>();
 	if ( ! patch->restartSuggested() )
-	  xml_print_patch( zypper, pi );
+	  xml_print_patch( zypper, xml, pi );
       }
     }
-    cout << "</blocked-update-list>" << endl;
+    xml << "</blocked-update-list>\n";
     }
   }
 
@@ -333,36 +355,119 @@ static void xml_list_updates(const ResKindSet & kinds)
   Candidates candidates;
   find_updates( kinds, candidates );
 
+  XmlWriter xml( cout );
   for( const PoolItem & pi : candidates )
   {
-    cout << " <update ";
-    cout << "name=\"" << pi.name () << "\" " ;
-    cout << "edition=\""  << pi.edition() << "\" ";
-    cout << "arch=\""  << pi.arch() << "\" ";
-    cout << "kind=\"" << pi.kind() << "\" ";
+    xml << " <update ";
+    xml << "name=\"" << pi.name () << "\" " ;
+    xml << "edition=\""  << pi.edition() << "\" ";
+    xml << "arch=\""  << pi.arch() << "\" ";
+    xml << "kind=\"" << pi.kind() << "\" ";
     // for packages show also the current installed version (bnc #466599)
     {
       const PoolItem & ipi( ui::Selectable::get(pi)->installedObj() );
       if ( ipi )
       {
 	if ( pi.edition() != ipi.edition() )
-	  cout << "edition-old=\""  << ipi.edition() << "\" ";
+	  xml << "edition-old=\""  << ipi.edition() << "\" ";
 	if ( pi.arch() != ipi.arch() )
-	  cout << "arch-old=\""  << ipi.arch() << "\" ";
+	  xml << "arch-old=\""  << ipi.arch() << "\" ";
       }
     }
-    cout << ">" << endl;
-    cout << "  <summary>" << xml::escape(pi.summary()) << "</summary>" << endl;
-    cout << "  <description>" << xml::escape(pi.description()) << "</description>" << endl;
-    cout << "  <license>" << xml::escape(pi.licenseToConfirm()) << "</license>" << endl;
+    xml << ">\n";
+    xml << "  <summary>" << XmlWriter::Text(pi.summary()) << "</summary>\n";
+    xml << "  <description>" << XmlWriter::Text(pi.description()) << "</description>\n";
+    xml << "  <license>" << XmlWriter::Text(pi.licenseToConfirm()) << "</license>\n";
 
     if ( !pi.repoInfo().alias().empty() )
     {
-        cout << "  <source url=\"" << xml::escape(pi.repoInfo().url().asString());
-        cout << "\" alias=\"" << xml::escape(pi.repoInfo().alias()) << "\"/>" << endl;
+        xml << "  <source url=\"" << XmlWriter::Text(pi.repoInfo().url().asString());
+        xml << "\" alias=\"" << XmlWriter::Text(pi.repoInfo().alias()) << "\"/>\n";
     }
 
-    cout << " </update>" << endl;
+    xml << " </update>\n";
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+static void json_print_patch( Zypper & zypper, const PoolItem & pi, bool blocked )
+{
+  Patch::constPtr patch = pi->asKind<Patch>();
+
+  JsonObject line;
+  line.add( "type", "update" )
+      .add( "kind", "patch" )
+      .add( "name", patch->name() )
+      .add( "edition", patch->edition().asString() )
+      .add( "arch", patch->arch().asString() )
+      .add( "status", xml_patchStatusAsString( pi ) )
+      .add( "category", patch->category() )
+      .add( "severity", patch->severity() )
+      .add( "pkgmanager", patch->restartSuggested() )
+      .add( "restart", patch->rebootSuggested() )
+      .add( "interactive", patch->interactiveWhenIgnoring( ignoredInteractiveFlags( zypper ) ) )
+      .add( "summary", patch->summary() )
+      .add( "repository", patch->repoInfo().alias() );
+  if ( blocked )
+    line.add( "blocked", true );
+  OutJSON::writeRow( line );
+}
+
+// JSON variant of xml_list_patches(): blocked patches are tagged instead of listed separately
+static bool json_list_patches( Zypper & zypper )
+{
+  const ResPool& pool = God->pool();
+
+  bool pkg_mgr_available = false;
+  for_( it, pool.byKindBegin(ResKind::patch), pool.byKindEnd(ResKind::patch) )
+  {
+    if ( patchIsApplicable( *it ) && (*it)->asKind<Patch>()->restartSuggested() )
+    {
+      pkg_mgr_available = true;
+      break;
+    }
+  }
+
+  bool all = zypper.cOpts().count("all");
+  for_( it, pool.byKindBegin(ResKind::patch), pool.byKindEnd(ResKind::patch) )
+  {
+    if ( all || patchIsApplicable( *it ) )
+    {
+      if ( all || !pkg_mgr_available || (*it)->asKind<Patch>()->restartSuggested() )
+	json_print_patch( zypper, *it, false );
+      else
+	json_print_patch( zypper, *it, true );
+    }
+  }
+  return pkg_mgr_available;
+}
+
+static void json_list_updates( const ResKindSet & kinds )
+{
+  Candidates candidates;
+  find_updates( kinds, candidates );
+
+  for( const PoolItem & pi : candidates )
+  {
+    JsonObject line;
+    line.add( "type", "update" )
+        .add( "kind", pi.kind().asString() )
+        .add( "name", pi.name() )
+        .add( "edition", pi.edition().asString() )
+        .add( "arch", pi.arch().asString() );
+    // for packages show also the current installed version (bnc #466599)
+    const PoolItem & ipi( ui::Selectable::get(pi)->installedObj() );
+    if ( ipi )
+    {
+      if ( pi.edition() != ipi.edition() )
+	line.add( "edition-old", ipi.edition().asString() );
+      if ( pi.arch() != ipi.arch() )
+	line.add( "arch-old", ipi.arch().asString() );
+    }
+    line.add( "summary", pi.summary() )
+        .add( "repository", pi.repoInfo().alias() );
+    OutJSON::writeRow( line );
   }
 }
 
@@ -568,6 +673,8 @@ void list_updates(Zypper & zypper, const ResKindSet & kinds, bool best_effort)
   {
     if (zypper.out().type() == Out::TYPE_XML)
       affects_pkgmgr = xml_list_patches(zypper);
+    else if (zypper.out().typeJSON())
+      affects_pkgmgr = json_list_patches(zypper);
     else
     {
       if (kinds.size() > 1)
@@ -594,6 +701,15 @@ void list_updates(Zypper & zypper, const ResKindSet & kinds, bool best_effort)
     return;
   }
 
+  // JSON output here
+  if (zypper.out().typeJSON())
+  {
+    if (!affects_pkgmgr)
+      json_list_updates(localkinds);
+    cout.flush();
+    return;
+  }
+
   if (affects_pkgmgr)
     return;
 
@@ -687,64 +803,42 @@ void list_patches_by_issue( Zypper & zypper )
   CliMatchPatch cliMatchPatch( zypper );
   bool only_needed = !zypper.cOpts().count("all");
 
-  // Basic PoolQuery tuned for each argument
-  PoolQuery basicQ;
-  basicQ.setMatchSubstring();
-  basicQ.setCaseSensitive( false );
-  basicQ.addKind( ResKind::patch );
+  // All issue references of the patches to consider, indexed in one pass
+  PatchIssueIndex index( [&]( const PoolItem & pi_r )->bool
+  {
+    if ( only_needed && ! patchIsApplicable( pi_r ) )
+      return false;
+
+    if ( ! cliMatchPatch( pi_r->asKind<Patch>() ) )
+    {
+      DBG << pi_r->ident() << " skipped. (not matching CLI filter)" << endl;
+      return false;
+    }
+    return true;
+  } );
 
   std::vector<const Issue*> pass2; // on the fly remember anyType issues for pass2
 
   for ( const Issue & issue : issues )
   {
     DBG << "querying: " << issue.type() << " = " << issue.id() << endl;
-    PoolQuery q( basicQ );
-    // PoolQuery ORs attributes but we need AND.
-    // Post processing the match must assert correct type of specific IDs!
-    if ( issue.specificType() && issue.anyId() )
-    { q.addAttribute(sat::SolvAttr::updateReferenceType, issue.type() ); }
-    else
-    {
-      q.addAttribute( sat::SolvAttr::updateReferenceId, issue.id() );
-      if ( issue.anyType() && issue.specificId() ) 				// remember for pass2
-      {
-	q.addAttribute( sat::SolvAttr::updateReferenceType, issue.id() );	// bnc#941309: let '--issue-bugzilla' also match the type
-	pass2.push_back( &issue );
-      }
-    }
+    // Ids from --issue-file are looked up as a whole and not
+    // searched in descriptions. That's what makes bulk lookups fast.
+    if ( issue.anyType() && issue.specificId() && ! issue.exact() )
+      pass2.push_back( &issue );
 
-    for_( it, q.begin(), q.end() )
+    index.forEachMatch( issue, issue.exact(), /*matchTypes*/true, [&t]( const PatchIssueIndex::Ref & ref_r )
     {
-      PoolItem pi( *it );
-      Patch::constPtr patch = asKind<Patch>(pi);
-
-      if ( only_needed && ! patchIsApplicable( pi ) )
-	continue;
-
-      if ( ! cliMatchPatch( patch ) )
-      {
-	DBG << patch->ident() << " skipped. (not matching CLI filter)" << endl;
-	continue;
-      }
-
-      // Print details about each match in that solvable:
-      for_( d, it.matchesBegin(), it.matchesEnd() )
-      {
-        const std::string & itype = d->subFind( sat::SolvAttr::updateReferenceType ).asString();
-
-	if ( issue.specificType() && itype != issue.type() )
-	  continue;	// assert correct type of specific IDs
-
-	t << ( TableRow()
-	  << itype
-	  << d->subFind( sat::SolvAttr::updateReferenceId ).asString()
-	  << patch->name()
-	  << patchHighlight(patch->category())
-	  << patchHighlight(patch->severity())
-	  << interactiveFlags(*patch)
-	  << i18nPatchStatusAsString( pi ) );
-      }
-    }
+      Patch::constPtr patch = asKind<Patch>( ref_r._pi );
+      t << ( TableRow()
+	<< ref_r._type
+	<< ref_r._id
+	<< patch->name()
+	<< patchHighlight(patch->category())
+	<< patchHighlight(patch->severity())
+	<< interactiveFlags(*patch)
+	<< i18nPatchStatusAsString( ref_r._pi ) );
+    } );
   }
 
   // pass2: look for matches in patch summary/description
@@ -752,6 +846,12 @@ void list_patches_by_issue( Zypper & zypper )
   Table t1;
   t1 << ( TableHeader() << _("Name") << _("Category") << _("Severity") << _("Interactive") << _("Summary") );
 
+  // Basic PoolQuery tuned for each argument
+  PoolQuery basicQ;
+  basicQ.setMatchSubstring();
+  basicQ.setCaseSensitive( false );
+  basicQ.addKind( ResKind::patch );
+
   for ( const Issue* _issue : pass2 )
   {
     const Issue & issue( *_issue );
@@ -820,11 +920,10 @@ void mark_updates_by_issue( Zypper & zypper )
 {
   CliScanIssues issues;
 
-  // Basic PoolQuery tuned for each argument
-  PoolQuery basicQ;
-  basicQ.setMatchExact();
-  basicQ.setCaseSensitive( false );
-  basicQ.addKind( ResKind::patch );
+  // All issue references of needed patches, indexed in one pass.
+  // CliMatchPatch not needed, it's fed into srOpts!
+  PatchIssueIndex index( []( const PoolItem & pi_r )->bool
+  { return pi_r.isBroken(); } );
 
   SolverRequester::Options srOpts;
   srOpts.force = zypper.cOpts().count("force");
@@ -833,43 +932,19 @@ void mark_updates_by_issue( Zypper & zypper )
 
   for ( const Issue & issue : issues )
   {
-    PoolQuery q( basicQ );
-    // PoolQuery ORs attributes but we need AND.
-    // Post processing the match must assert correct type of specific IDs!
-    if ( issue.specificType() && issue.anyId() )
-    { q.addAttribute(sat::SolvAttr::updateReferenceType, issue.type() ); }
-    else
-    { q.addAttribute( sat::SolvAttr::updateReferenceId, issue.id() ); }
-
     SolverRequester sr( srOpts );
     bool found = false;
 
-    for_( it, q.begin(), q.end() )
+    // Issue ids are matched as a whole (case insensitive), and only as ids
+    index.forEachMatch( issue, /*exact*/true, /*matchTypes*/false, [&]( const PatchIssueIndex::Ref & ref_r )
     {
-      PoolItem pi( *it );
-      Patch::constPtr patch = asKind<Patch>(pi);
-
-      if ( !pi.isBroken() ) // not needed
-	continue;
-
-      // CliMatchPatch not needed, it's fed into srOpts!
-
-      DBG << "got: " << *it << endl;
-
-      for_( d, it.matchesBegin(), it.matchesEnd() )
-      {
-	const std::string & itype = d->subFind( sat::SolvAttr::updateReferenceType ).asString();
-
-	if ( issue.specificType() && itype != issue.type() )
-	  continue;	// assert correct type of specific IDs
-
-	if ( sr.installPatch( pi ) )
-	  found = true;
-	else
-	  DBG << str::form("fix for %s issue number %s was not marked.",
-			   issue.type().c_str(), issue.id().c_str() );
-      }
-    }
+      DBG << "got: " << ref_r._pi << endl;
+      if ( sr.installPatch( ref_r._pi ) )
+	found = true;
+      else
+	DBG << str::form("fix for %s issue number %s was not marked.",
+			 issue.type().c_str(), issue.id().c_str() );
+    } );
 
     sr.printFeedback( zypper.out() );
     if ( ! found )
@@ -0,0 +1,256 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <system_error>
+
+#include <zypp/base/String.h>
+
+#include "utils/AsyncLogWriter.h"
+
+using zypp::base::LogControl;
+
+AsyncLogWriter * AsyncLogWriter::_instance = nullptr;
+
+namespace
+{
+  /** Set while a thread is inside \ref AsyncLogWriter::push (guards against signal handlers). */
+  thread_local bool t_inWrite = false;
+
+  /** Whether \a line_r was formatted by LogControl at DEBUG level (<tt>"date time <0> ..."</tt>). */
+  inline bool isDebugLine( const std::string & line_r )
+  {
+    std::string::size_type pos = line_r.find( " <" );
+    return pos != std::string::npos && pos < 32 && line_r.compare( pos, 5, " <0> " ) == 0;
+  }
+} // namespace
+
+// ---------------------------------------------------------------------------
+
+void AsyncLogWriter::install()
+{
+  if ( _instance )
+    return;
+  zypp::shared_ptr<LineWriter> target( LogControl::instance().getLineWriter() );
+  if ( ! target )
+    return;	// logging is off
+  LogControl::instance().setLineWriter( zypp::shared_ptr<LineWriter>( new AsyncLogWriter( target ) ) );
+  ::pthread_atfork( nullptr, nullptr, &AsyncLogWriter::forkedChild );
+}
+
+void AsyncLogWriter::forkedChild()
+{
+  if ( _instance )
+  {
+    // lines still queued are written by the parent
+    _instance->_running = false;
+    _instance->_producerLock.clear();
+    _instance->_thread.release();	// not ours to join
+  }
+}
+
+void AsyncLogWriter::flush()
+{
+  if ( _instance )
+    _instance->waitWritten();
+}
+
+// ---------------------------------------------------------------------------
+
+AsyncLogWriter::AsyncLogWriter( const zypp::shared_ptr<LineWriter> & target_r, unsigned capacity_r )
+: _target( target_r )
+, _ring( capacity_r ? capacity_r : 1 )
+, _head( 0 )
+, _tail( 0 )
+, _written( 0 )
+, _dropped( 0 )
+, _running( false )
+, _stop( false )
+, _idle( false )
+{
+  _producerLock.clear();
+  _instance = this;
+
+  if ( ::pipe2( _wakeupPipe, O_NONBLOCK | O_CLOEXEC ) != 0 )
+  {
+    _wakeupPipe[0] = _wakeupPipe[1] = -1;
+    return;	// stay synchronous
+  }
+
+  // The writer thread must not catch SIGINT/SIGTERM meant for the main thread.
+  sigset_t all, old;
+  ::sigfillset( &all );
+  ::pthread_sigmask( SIG_SETMASK, &all, &old );
+  try
+  {
+    _thread.reset( new std::thread( &AsyncLogWriter::run, this ) );
+    _running = true;
+  }
+  catch ( const std::system_error & )
+  {}	// stay synchronous
+  ::pthread_sigmask( SIG_SETMASK, &old, nullptr );
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+  stop();
+  if ( _wakeupPipe[0] != -1 )
+  {
+    ::close( _wakeupPipe[0] );
+    ::close( _wakeupPipe[1] );
+  }
+  if ( _instance == this )
+    _instance = nullptr;
+}
+
+// ---------------------------------------------------------------------------
+
+void AsyncLogWriter::writeOut( const std::string & formated_r )
+{
+  if ( ! _running )
+  {
+    _target->writeOut( formated_r );
+    return;
+  }
+  if ( t_inWrite )
+    return;	// re-entered from a signal handler; the ring is in use by this thread
+
+  t_inWrite = true;
+  while ( _producerLock.test_and_set( std::memory_order_acquire ) )
+    std::this_thread::yield();
+
+  if ( _running )
+  {
+    bool debug = isDebugLine( formated_r );
+    if ( ! debug && _dropped )
+    {
+      // summarize the dropped lines using the timestamp of the current one
+      std::string::size_type pos = formated_r.find( " <" );
+      std::string stamp( pos == std::string::npos ? std::string() : formated_r.substr( 0, pos ) );
+      push( zypp::str::form( "%s <1> [zypper] %lu DEBUG lines dropped (log writer busy)",
+                             stamp.c_str(), _dropped.load() ), false );
+      _dropped = 0;
+    }
+    if ( ! push( formated_r, debug ) )
+      ++_dropped;
+  }
+  else
+    _target->writeOut( formated_r );
+
+  _producerLock.clear( std::memory_order_release );
+  t_inWrite = false;
+}
+
+bool AsyncLogWriter::push( const std::string & formated_r, bool droppable_r )
+{
+  unsigned long cap = _ring.size();
+  unsigned long tail = _tail.load( std::memory_order_relaxed );
+
+  // Keep the last quarter of the ring for non DEBUG lines.
+  if ( droppable_r && tail - _head.load( std::memory_order_acquire ) >= cap - cap / 4 )
+    return false;
+
+  while ( tail - _head.load( std::memory_order_acquire ) >= cap )
+  {
+    wakeup();
+    std::this_thread::yield();
+  }
+
+  _ring[tail % cap] = formated_r;
+  _tail.store( tail + 1, std::memory_order_release );
+  wakeup();
+  return true;
+}
+
+void AsyncLogWriter::wakeup()
+{
+  // Async-signal-safe: reached from the signal handler via flush().
+  // A full pipe already holds a pending wakeup, so EAGAIN is fine.
+  if ( _idle.load() )
+  {
+    char c = 0;
+    while ( ::write( _wakeupPipe[1], &c, 1 ) == -1 && errno == EINTR )
+    {}
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+void AsyncLogWriter::run()
+{
+  // NOTE: never log from here; LogControl would call us again.
+  unsigned long cap = _ring.size();
+  for (;;)
+  {
+    unsigned long head = _head.load( std::memory_order_relaxed );
+    if ( head == _tail.load( std::memory_order_acquire ) )
+    {
+      if ( _stop )
+        break;
+
+      _idle = true;
+      if ( head == _tail.load() && ! _stop )
+      {
+        struct pollfd pfd = { _wakeupPipe[0], POLLIN, 0 };
+        if ( ::poll( &pfd, 1, 100 ) > 0 )
+        {
+          char buf[64];
+          while ( ::read( _wakeupPipe[0], buf, sizeof(buf) ) > 0 )
+          {}
+        }
+      }
+      _idle = false;
+      continue;
+    }
+
+    std::string line;
+    line.swap( _ring[head % cap] );
+    _head.store( head + 1, std::memory_order_release );
+    _target->writeOut( line );
+    _written.store( head + 1, std::memory_order_release );
+  }
+}
+
+void AsyncLogWriter::waitWritten()
+{
+  if ( ! _running )
+    return;
+  unsigned long tail = _tail.load( std::memory_order_acquire );
+  while ( _written.load( std::memory_order_acquire ) < tail )
+  {
+    wakeup();
+    std::this_thread::yield();
+  }
+}
+
+void AsyncLogWriter::stop()
+{
+  if ( ! _running )
+    return;
+
+  waitWritten();
+  _stop = true;
+  _idle = true;	// make sure wakeup() writes to the pipe
+  wakeup();
+  if ( _thread && _thread->joinable() )
+    _thread->join();
+
+  // write what was queued meanwhile and switch to synchronous mode
+  while ( _producerLock.test_and_set( std::memory_order_acquire ) )
+    std::this_thread::yield();
+  unsigned long cap = _ring.size();
+  for ( unsigned long head = _head; head < _tail; ++head )
+    _target->writeOut( _ring[head % cap] );
+  _head.store( _tail.load() );
+  _written.store( _tail.load() );
+  _running = false;
+  _producerLock.clear( std::memory_order_release );
+}
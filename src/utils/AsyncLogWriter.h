@@ -0,0 +1,84 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#ifndef ZYPPER_UTILS_ASYNCLOGWRITER_H_
+#define ZYPPER_UTILS_ASYNCLOGWRITER_H_
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+
+#include <zypp/base/LogControl.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class AsyncLogWriter
+/// \brief LogControl line writer passing lines to a background thread.
+///
+/// Formatted log lines are put into a bounded ring buffer and written
+/// to the wrapped (usually file) line writer by a dedicated thread, so
+/// the main thread does not wait for the logfile. If the buffer runs
+/// full, DEBUG lines are dropped (and their number is logged later);
+/// all other lines wait for free space and are never lost.
+///
+/// The ring is single consumer, but not lock-free on the producer side:
+/// threads logging concurrently serialize on a spinlock held while one
+/// line is copied into the ring (zypper logs mostly from the main thread).
+/// A signal handler logging while its thread holds the lock drops the line.
+///
+/// Call \ref flush to have everything written (e.g. before \c exit).
+/// It takes no locks and may be called from a signal handler; the idle
+/// writer thread is woken through a pipe rather than a condition variable.
+/// A forked child process writes synchronously. The destructor writes
+/// all queued lines.
+///////////////////////////////////////////////////////////////////
+class AsyncLogWriter : public zypp::base::LogControl::LineWriter
+{
+public:
+  typedef zypp::base::LogControl::LineWriter LineWriter;
+
+  /** Wrap the current \ref zypp::base::LogControl line writer (if any). */
+  static void install();
+
+  /** Wait until all queued lines are written. */
+  static void flush();
+
+public:
+  AsyncLogWriter( const zypp::shared_ptr<LineWriter> & target_r, unsigned capacity_r = 4096 );
+  virtual ~AsyncLogWriter();
+
+  virtual void writeOut( const std::string & formated_r );
+
+private:
+  /** pthread_atfork child handler: the forked process has no writer thread. */
+  static void forkedChild();
+
+  bool push( const std::string & formated_r, bool droppable_r );
+  void run();
+  void stop();
+  void waitWritten();
+  void wakeup();
+
+private:
+  zypp::shared_ptr<LineWriter> _target;
+  std::vector<std::string> _ring;
+  std::atomic<unsigned long> _head;	///< next line to write (consumer)
+  std::atomic<unsigned long> _tail;	///< next free slot (producer)
+  std::atomic<unsigned long> _written;	///< lines passed to _target
+  std::atomic<unsigned long> _dropped;	///< DEBUG lines dropped and not yet reported
+  std::atomic_flag _producerLock;
+  std::atomic<bool> _running;
+  std::atomic<bool> _stop;
+  std::atomic<bool> _idle;
+  int _wakeupPipe[2];			///< the idle writer thread polls the read end
+  std::unique_ptr<std::thread> _thread;
+
+  static AsyncLogWriter * _instance;
+};
+
+#endif /* ZYPPER_UTILS_ASYNCLOGWRITER_H_ */
@@ -0,0 +1,214 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <unordered_set>
+#include <stdlib.h>
+#include <ctype.h>
+
+#include <zypp/base/Logger.h>
+#include <zypp/base/String.h>
+#include <zypp/PathInfo.h>
+
+#include "Zypper.h"
+#include "utils/IniConfig.h"
+
+IniConfig::IniConfig( const std::string & file )
+{
+  MIL << "Going to read zypper config..." << endl;
+
+  // if file is specified, try to load the file, fall back to default files
+  // default - /etc/zypp/zypper.conf & $HOME/.zypper.conf
+  Pathname filepath( file );
+  Pathname userpath;
+  bool want_custom = false;
+  if ( !file.empty() && PathInfo(filepath).isExist() )
+  {
+    want_custom = true;
+    if ( filepath.relative() )
+    {
+      const char * env = ::getenv("PWD");
+      std::string wd( env ? env : "." );
+      filepath = wd / filepath;
+    }
+    userpath = filepath;
+  }
+  else
+  {
+    const char * env = ::getenv("HOME");
+    std::string homedir( env ? env : "" );
+    if ( homedir.empty() )
+      WAR << "Cannot figure out user's home directory. Skipping user's config." << endl;
+    else
+      userpath = homedir + "/.zypper.conf";
+  }
+
+  std::string error;
+  bool got_global = false;
+  if ( !want_custom )
+  {
+    std::string err;
+    got_global = parse( "/etc/zypp/zypper.conf", _global_options, err );
+    if ( !err.empty() )
+      error = err;
+  }
+
+  bool got_user = false;
+  if ( !userpath.empty() )
+  {
+    std::string err;
+    got_user = parse( userpath, _user_options, err );
+    if ( !err.empty() )
+    {
+      if ( ! error.empty() )
+	error += "\n";
+      error += err;
+    }
+  }
+
+  if ( !got_global && !got_user && !error.empty() )
+  {
+    std::string msg(_("Error parsing zypper.conf:") + std::string("\n") + error);
+    ZYPP_THROW(Exception(msg));
+  }
+
+  MIL << "Done reading conf files:" << endl;
+  if (want_custom)
+    MIL << "custom conf read: " << (got_user ? "yes" : "no") << endl;
+  else
+  {
+    MIL << "user conf read: " << (got_user ? "yes" : "no") << endl;
+    MIL << "global conf read: " << (got_global ? "yes" : "no") << endl;
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+/** Option name as accepted by the lens: [a-zA-Z][a-zA-Z0-9._]*[a-zA-Z0-9] */
+static bool valid_key( const std::string & key_r )
+{
+  if ( key_r.size() < 2 || ! ::isalpha( key_r[0] ) || ! ::isalnum( key_r[key_r.size()-1] ) )
+    return false;
+  for_( ch, key_r.begin(), key_r.end() )
+    if ( ! ::isalnum( *ch ) && *ch != '.' && *ch != '_' )
+      return false;
+  return true;
+}
+
+bool IniConfig::parse( const Pathname & file_r, Options & options_r, std::string & error_r )
+{
+  std::ifstream in( file_r.c_str() );
+  if ( ! in )
+  {
+    DBG << file_r << " not readable" << endl;
+    return false;
+  }
+
+  // Same syntax as accepted by the former zypper.aug Augeas lens:
+  //   [section]
+  //   key = value
+  //   # commented / ## description lines
+  Options options;
+  std::unordered_set<std::string> duplicates;
+  std::string section;
+  std::string line;
+  unsigned lineno = 0;
+  while ( std::getline( in, line ) )
+  {
+    ++lineno;
+    line = str::trim( line );
+    if ( line.empty() || line[0] == '#' )
+      continue;
+
+    std::string err;
+    if ( line[0] == '[' )
+    {
+      std::string::size_type end = line.find( ']' );
+      if ( end == std::string::npos || end != line.size() - 1 || end == 1 )
+        err = "invalid section header";
+      else
+      {
+        section = line.substr( 1, end - 1 );
+        if ( section.find_first_of( " \t/" ) != std::string::npos )
+          err = "invalid section name '" + section + "'";
+      }
+    }
+    else if ( section.empty() )
+      err = "option outside of a section";
+    else
+    {
+      std::string::size_type eq = line.find( '=' );
+      std::string key( eq == std::string::npos ? std::string() : str::trim( line.substr( 0, eq ) ) );
+      if ( key.empty() )
+        err = "expected 'key = value'";
+      else if ( ! valid_key( key ) )
+        err = "invalid option name '" + key + "'";
+      else
+      {
+        std::string value( str::trim( line.substr( eq + 1 ) ) );
+        if ( value.empty() )
+          err = "missing value for '" + key + "'";
+        else
+        {
+          // Like with Augeas, an option set multiple times in a file is
+          // ignored there (the one from the global file applies).
+          std::string option( section + "/" + key );
+          if ( ! duplicates.count( option ) && ! options.insert( Options::value_type( option, value ) ).second )
+          {
+            WAR << file_r << ":" << lineno << ": option " << option << " set multiple times, ignoring it" << endl;
+            options.erase( option );
+            duplicates.insert( option );
+          }
+        }
+      }
+    }
+
+    if ( ! err.empty() )
+    {
+      // like with the Augeas lens: a parse error invalidates the whole file
+      error_r = str::form( "%s:%u: %s", file_r.c_str(), lineno, err.c_str() );
+      ERR << error_r << endl;
+      return false;
+    }
+  }
+
+  options_r.swap( options );
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+std::string IniConfig::getOption( const std::string & option ) const
+{
+  std::vector<std::string> opt;
+  str::split( option, back_inserter(opt), "/" );
+
+  if ( opt.size() != 2 || opt[0].empty() || opt[1].empty() )
+  {
+    ERR << "invalid option " << option << endl;
+    return std::string();
+  }
+
+  Options::const_iterator it( _user_options.find( option ) );
+  if ( it != _user_options.end() )
+  {
+    DBG << "Got " << option << " = " << it->second << " (user)" << endl;
+    return it->second;
+  }
+
+  it = _global_options.find( option );
+  if ( it != _global_options.end() )
+  {
+    DBG << "Got " << option << " = " << it->second << endl;
+    return it->second;
+  }
+
+  return std::string();
+}
+
+// ---------------------------------------------------------------------------
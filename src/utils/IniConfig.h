@@ -0,0 +1,45 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#ifndef ZYPPER_UTIL_INICONFIG_H_
+#define ZYPPER_UTIL_INICONFIG_H_
+
+#include <string>
+#include <unordered_map>
+
+#include <zypp/base/NonCopyable.h>
+#include <zypp/Pathname.h>
+
+/**
+ * Native reader for zypper.conf.
+ *
+ * A custom \c file (if it exists) replaces the default ones, otherwise
+ * options from \c $HOME/.zypper.conf override those from
+ * \c /etc/zypp/zypper.conf. Accepts the syntax of the former Augeas
+ * lens; a syntax error makes the whole file unusable. An option set more
+ * than once in a file is ignored in that file (with a warning).
+ */
+class IniConfig : private zypp::base::NonCopyable
+{
+public:
+  IniConfig( const std::string & file = "" );
+
+  /** Value of \c "section/option" or an empty string if not set. */
+  std::string getOption( const std::string & option ) const;
+
+public:
+  typedef std::unordered_map<std::string, std::string> Options;
+
+  /** Parse \a file_r into \a options_r; returns false and sets \a error_r on failure. */
+  static bool parse( const zypp::Pathname & file_r, Options & options_r, std::string & error_r );
+
+private:
+  Options _user_options;
+  Options _global_options;
+};
+
+#endif /* ZYPPER_UTIL_INICONFIG_H_ */
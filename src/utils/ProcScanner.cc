@@ -0,0 +1,322 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+#include <dirent.h>
+#include <fcntl.h>
+#include <pwd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+
+#include <zypp/base/Logger.h>
+#include <zypp/base/String.h>
+#include <zypp/PathInfo.h>
+#include <zypp/misc/CheckAccessDeleted.h>
+
+#include "utils/ProcScanner.h"
+
+using namespace zypp;
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  // NOTE: Everything in this namespace runs in worker threads.
+  // No logging here; it is not thread safe.
+
+  /** Read a (small or huge) /proc file at once. */
+  bool readProcFile( const std::string & path_r, std::string & content_r )
+  {
+    content_r.clear();
+    int fd = ::open( path_r.c_str(), O_RDONLY|O_CLOEXEC );
+    if ( fd < 0 )
+      return false;
+
+    static const size_t chunk = 64 * 1024;
+    for (;;)
+    {
+      size_t have = content_r.size();
+      content_r.resize( have + chunk );
+      ssize_t got = ::read( fd, &content_r[have], chunk );
+      if ( got <= 0 )
+      {
+	content_r.resize( have );
+	break;
+      }
+      content_r.resize( have + got );
+    }
+    ::close( fd );
+    return true;
+  }
+
+  /** Deleted files we are not interested in (like lsof/CheckAccessDeleted non-verbose). */
+  inline bool ignoredFile( const char * path_r, size_t len_r )
+  {
+    static const std::vector<std::string> ignore = {
+      "/SYSV", "/memfd:", "/[", "/dev/", "/run/", "/var/run/", "/tmp/", "/var/tmp/",
+    };
+    for ( const auto & prefix : ignore )
+    {
+      if ( len_r >= prefix.size() && ::strncmp( path_r, prefix.c_str(), prefix.size() ) == 0 )
+	return true;
+    }
+    return false;
+  }
+
+  /** The systemd service (without ".service") from a /proc/PID/cgroup file. */
+  std::string serviceFromCgroup( const std::string & cgroup_r )
+  {
+    //   1:name=systemd:/system.slice/systemd-udevd.service
+    //   0::/system.slice/systemd-udevd.service
+    std::string ret;
+    std::string::size_type pos = 0;
+    while ( pos < cgroup_r.size() )
+    {
+      std::string::size_type eol = cgroup_r.find( '\n', pos );
+      if ( eol == std::string::npos )
+	eol = cgroup_r.size();
+      std::string line( cgroup_r, pos, eol - pos );
+      pos = eol + 1;
+
+      bool v1 = ( line.find( ":name=systemd:" ) != std::string::npos );
+      if ( ! ( v1 || line.compare( 0, 3, "0::" ) == 0 ) )
+	continue;
+      std::string::size_type slice = line.find( "/system.slice/" );
+      if ( slice == std::string::npos )
+	continue;
+
+      // last path component ending in .service
+      std::string::size_type end = line.rfind( ".service" );
+      if ( end == std::string::npos || end < slice )
+	continue;
+      std::string::size_type start = line.rfind( '/', end );
+      ret = line.substr( start + 1, end - start - 1 );
+      if ( v1 )
+	break;	// prefer the named systemd hierarchy
+    }
+    return ret;
+  }
+
+  /** Value of a "Key:\tvalue" line in /proc/PID/status. */
+  long statusValue( const std::string & status_r, const char * key_r )
+  {
+    std::string::size_type pos = status_r.find( key_r );
+    if ( pos == std::string::npos )
+      return -1;
+    return ::strtol( status_r.c_str() + pos + ::strlen( key_r ), nullptr, 10 );
+  }
+
+  /** Per thread scanner; caches the verdict per (device, inode). */
+  struct MapsScanner
+  {
+    MapsScanner( const Pathname & proc_r, const ProcScanner::FileFilter & filter_r )
+    : _proc( proc_r.asString() + "/" )
+    , _filter( filter_r )
+    {}
+
+    /** Scan one process; \c true if it uses deleted files. */
+    bool scan( const std::string & pid_r, ProcScanner::ProcInfo & info_r )
+    {
+      if ( ! readProcFile( _proc + pid_r + "/maps", _buf ) )
+	return false;
+
+      static const char deleted[] = " (deleted)";
+      static const size_t deletedLen = sizeof(deleted) - 1;
+
+      std::vector<int> files;
+      const char * data = _buf.c_str();
+      size_t pos = 0;
+      while ( pos < _buf.size() )
+      {
+	const char * line = data + pos;
+	const char * eol = static_cast<const char *>( ::memchr( line, '\n', _buf.size() - pos ) );
+	size_t len = eol ? eol - line : _buf.size() - pos;
+	pos += len + 1;
+
+	if ( len <= deletedLen || ::memcmp( line + len - deletedLen, deleted, deletedLen ) != 0 )
+	  continue;
+
+	// address perms offset dev inode path
+	const char * p = line;
+	const char * lend = line + len;
+	for ( unsigned field = 0; field < 3 && p < lend; ++field )
+	{
+	  p = static_cast<const char *>( ::memchr( p, ' ', lend - p ) );
+	  if ( ! p ) break;
+	  ++p;
+	}
+	if ( ! p || p >= lend )
+	  continue;
+	const char * devinode = p;	// "dev inode"
+	p = static_cast<const char *>( ::memchr( p, ' ', lend - p ) );	// after dev
+	if ( ! p ) continue;
+	++p;
+	const char * inodeEnd = static_cast<const char *>( ::memchr( p, ' ', lend - p ) );
+	if ( ! inodeEnd || ( inodeEnd - p == 1 && *p == '0' ) )
+	  continue;	// anonymous mapping
+
+	std::string key( devinode, inodeEnd - devinode );
+	auto it = _verdict.find( key );
+	if ( it == _verdict.end() )
+	{
+	  int idx = -1;
+	  const char * path = static_cast<const char *>( ::memchr( inodeEnd, '/', lend - inodeEnd ) );
+	  if ( path )
+	  {
+	    size_t plen = ( lend - deletedLen ) - path;
+	    std::string file( path, plen );
+	    if ( ! ignoredFile( path, plen ) && ( ! _filter || _filter( file ) ) )
+	    {
+	      idx = _paths.size();
+	      _paths.push_back( std::move( file ) );
+	    }
+	  }
+	  it = _verdict.insert( std::make_pair( std::move( key ), idx ) ).first;
+	}
+	if ( it->second >= 0 )
+	  files.push_back( it->second );
+      }
+
+      if ( files.empty() )
+	return false;
+
+      std::sort( files.begin(), files.end() );
+      files.erase( std::unique( files.begin(), files.end() ), files.end() );
+      info_r.files.clear();
+      for ( int idx : files )
+	info_r.files.push_back( _paths[idx] );
+      std::sort( info_r.files.begin(), info_r.files.end() );
+
+      info_r.pid = ::strtol( pid_r.c_str(), nullptr, 10 );
+      if ( readProcFile( _proc + pid_r + "/status", _buf ) )
+      {
+	info_r.ppid = statusValue( _buf, "\nPPid:" );
+	info_r.puid = statusValue( _buf, "\nUid:" );
+      }
+      if ( readProcFile( _proc + pid_r + "/comm", _buf ) )
+	info_r.command = str::rtrim( _buf );
+      if ( readProcFile( _proc + pid_r + "/cgroup", _buf ) )
+	info_r.service = serviceFromCgroup( _buf );
+      return true;
+    }
+
+  private:
+    std::string _proc;
+    const ProcScanner::FileFilter & _filter;
+    std::string _buf;
+    std::unordered_map<std::string,int> _verdict;	//< "dev inode" -> index in _paths or -1
+    std::vector<std::string> _paths;
+  };
+
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+bool ProcScanner::scan( const FileFilter & filter_r )
+{
+  _procs.clear();
+  if ( scanProc( "/proc", filter_r ) )
+    return true;
+
+  WAR << "/proc not usable, falling back to lsof" << endl;
+  scanLsof( filter_r );
+  return false;
+}
+
+bool ProcScanner::scanProc( const Pathname & proc_r, const FileFilter & filter_r )
+{
+  if ( ! PathInfo( proc_r / "self/maps" ).isFile() )
+    return false;
+
+  std::vector<std::string> pids;
+  {
+    DIR * dir = ::opendir( proc_r.c_str() );
+    if ( ! dir )
+      return false;
+    while ( struct dirent * ent = ::readdir( dir ) )
+    {
+      if ( ent->d_name[0] >= '1' && ent->d_name[0] <= '9' )
+	pids.push_back( ent->d_name );
+    }
+    ::closedir( dir );
+  }
+
+  unsigned nthreads = std::min( std::max( std::thread::hardware_concurrency(), 1U ), 8U );
+  if ( pids.size() < 64 )
+    nthreads = 1;
+  MIL << "Scanning " << pids.size() << " processes using " << nthreads << " threads" << endl;
+
+  // each thread collects its own results; merged afterwards
+  std::vector<ProcInfoList> results( nthreads );
+  std::atomic<unsigned> next( 0 );
+  auto work = [&]( unsigned slot_r ) {
+    MapsScanner scanner( proc_r, filter_r );
+    static const unsigned batch = 16;
+    for ( unsigned begin = next.fetch_add( batch ); begin < pids.size(); begin = next.fetch_add( batch ) )
+    {
+      unsigned end = std::min<unsigned>( begin + batch, pids.size() );
+      for ( unsigned i = begin; i < end; ++i )
+      {
+	ProcInfo info { 0, 0, uid_t(-1), std::string(), std::string(), std::string(), std::vector<std::string>() };
+	if ( scanner.scan( pids[i], info ) )
+	  results[slot_r].push_back( std::move( info ) );
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for ( unsigned i = 1; i < nthreads; ++i )
+  {
+    try { threads.push_back( std::thread( work, i ) ); }
+    catch ( const std::system_error & ) { break; }	// fewer threads then
+  }
+  work( 0 );
+  for ( auto & thread : threads )
+    thread.join();
+
+  for ( auto & result : results )
+    std::move( result.begin(), result.end(), std::back_inserter( _procs ) );
+  std::sort( _procs.begin(), _procs.end(), []( const ProcInfo & lhs, const ProcInfo & rhs ) { return lhs.pid < rhs.pid; } );
+
+  // getpwuid is not thread safe
+  std::map<uid_t,std::string> logins;
+  for ( auto & proc : _procs )
+  {
+    auto it = logins.find( proc.puid );
+    if ( it == logins.end() )
+    {
+      struct passwd * pw = ::getpwuid( proc.puid );
+      it = logins.insert( std::make_pair( proc.puid, pw ? std::string( pw->pw_name ) : str::numstring( proc.puid ) ) ).first;
+    }
+    proc.login = it->second;
+  }
+
+  MIL << "Found " << _procs.size() << " processes using deleted files" << endl;
+  return true;
+}
+
+void ProcScanner::scanLsof( const FileFilter & filter_r )
+{
+  CheckAccessDeleted checker( false );	// wait for explicit call to check()
+  checker.check();
+  for ( const auto & procInfo : checker )
+  {
+    ProcInfo info { str::strtonum<pid_t>( procInfo.pid ), str::strtonum<pid_t>( procInfo.ppid ), str::strtonum<uid_t>( procInfo.puid ),
+                    procInfo.login, procInfo.command, procInfo.service(), std::vector<std::string>() };
+    for ( const auto & file : procInfo.files )
+    {
+      if ( ! filter_r || filter_r( file ) )
+	info.files.push_back( file );
+    }
+    if ( ! info.files.empty() )
+      _procs.push_back( std::move( info ) );
+  }
+}
@@ -0,0 +1,78 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#ifndef ZYPPER_UTILS_PROCSCANNER_H_
+#define ZYPPER_UTILS_PROCSCANNER_H_
+
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include <zypp/Pathname.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class ProcScanner
+/// \brief Find running processes using deleted files.
+///
+/// Native replacement for \ref zypp::CheckAccessDeleted (which parses
+/// the output of \c lsof). The \c /proc/PID entries are partitioned
+/// across threads, each reading \c /proc/PID/maps with large buffered
+/// reads. Mappings of the same (device, inode) are evaluated once per
+/// thread.
+///
+/// Like the non-verbose \c CheckAccessDeleted, only mapped files
+/// (executables, libraries, ...) are reported; deleted files in
+/// temporary and runtime directories are ignored.
+///
+/// If \c /proc is not usable, \ref scan falls back to
+/// \ref zypp::CheckAccessDeleted.
+///////////////////////////////////////////////////////////////////
+class ProcScanner
+{
+public:
+  /** Data about a process using deleted files (see \ref zypp::CheckAccessDeleted::ProcInfo). */
+  struct ProcInfo
+  {
+    pid_t pid;				//< process ID
+    pid_t ppid;				//< parent process ID
+    uid_t puid;				//< process user ID
+    std::string login;			//< process login name
+    std::string command;		//< process command name
+    std::string service;		//< systemd service running the process (if any)
+    std::vector<std::string> files;	//< deleted files or libraries accessed
+  };
+  typedef std::vector<ProcInfo> ProcInfoList;
+  typedef ProcInfoList::const_iterator const_iterator;
+
+  /** Report only deleted files accepted by the filter. */
+  typedef std::function<bool( const std::string & )> FileFilter;
+
+public:
+  ProcScanner()
+  {}
+
+  /** Scan the running processes (throws if the \c lsof fallback fails).
+   * \return whether \c /proc was scanned (rather than using the fallback).
+   */
+  bool scan( const FileFilter & filter_r = FileFilter() );
+
+  bool empty() const			{ return _procs.empty(); }
+  ProcInfoList::size_type size() const	{ return _procs.size(); }
+  const_iterator begin() const		{ return _procs.begin(); }
+  const_iterator end() const		{ return _procs.end(); }
+
+private:
+  bool scanProc( const zypp::Pathname & proc_r, const FileFilter & filter_r );
+  void scanLsof( const FileFilter & filter_r );
+
+private:
+  ProcInfoList _procs;
+};
+
+#endif /* ZYPPER_UTILS_PROCSCANNER_H_ */
@@ -13,6 +13,8 @@
 #include <zypp/base/String.h>
 #include <zypp/base/Easy.h>
 #include <zypp/base/Regex.h>
+#include <zypp/base/IOStream.h>
+#include <zypp/base/InputStream.h>
 #include <zypp/media/MediaManager.h>
 #include <zypp/ExternalProgram.h>
 #include "zypp/parser/ProductFileReader.h"
@@ -401,6 +403,35 @@ std::string & indent( std::string & text, int columns )
   return text;
 }
 
+// ----------------------------------------------------------------------------
+
+bool read_list_file( const std::string & file_r, std::vector<std::string> & lines_r )
+{
+  InputStream istr;	// default is stdin
+  if ( file_r != "-" )
+  {
+    PathInfo pi( file_r );
+    if ( ! pi.isFile() || ! pi.userMayR() )
+    {
+      Zypper::instance()->out().error( str::Format(_("Cannot read file '%s'.")) % file_r );
+      ERR << "Cannot read list file " << pi << endl;
+      return false;
+    }
+    istr = InputStream( pi.path() );
+  }
+
+  unsigned before = lines_r.size();
+  iostr::forEachLine( istr.stream(), [&lines_r]( int num_r, std::string line_r )->bool
+  {
+    line_r = str::trim( line_r );
+    if ( ! line_r.empty() && line_r[0] != '#' )
+      lines_r.push_back( std::move(line_r) );
+    return true;
+  } );
+  MIL << "Read " << ( lines_r.size() - before ) << " entries from " << file_r << endl;
+  return true;
+}
+
 /**
  * \todo this is an ugly quick-hack code, let's do something reusable and maintainable in libzypp later
  */
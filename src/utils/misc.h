@@ -11,6 +11,7 @@
 #include <string>
 #include <set>
 #include <list>
+#include <vector>
 
 #include <zypp/Url.h>
 #include <zypp/Pathname.h>
@@ -87,6 +88,15 @@ Pathname cache_rpm( const std::string & rpm_uri_str, const std::string & cache_d
 
 std::string & indent( std::string & text, int columns );
 
+/**
+ * Read a list of entries from \a file_r, one per line (\c "-" reads stdin).
+ * Leading and trailing whitespace is stripped, empty lines and lines starting
+ * with \c '#' are skipped. Entries are appended to \a lines_r.
+ *
+ * \return \c false (after reporting an error) if the file can not be read.
+ */
+bool read_list_file( const std::string & file_r, std::vector<std::string> & lines_r );
+
 // comparator for RepoInfo set
 struct RepoInfoAliasComparator
 {
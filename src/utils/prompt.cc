@@ -201,7 +201,7 @@ int read_action_ari_with_timeout( PromptId pid, unsigned timeout, int default_ac
 				      "Autoselecting '%s' after %u seconds.",
 				      timeout)) % poptions.options()[default_action] % timeout;
 
-    if ( zypper.out().type() == Out::TYPE_XML )
+    if ( ! zypper.out().typeNORMAL() )
       zypper.out().info( msg );	// maybe progress??
     else
     {
@@ -213,7 +213,7 @@ int read_action_ari_with_timeout( PromptId pid, unsigned timeout, int default_ac
     --timeout;
   }
 
-  if ( zypper.out().type() != Out::TYPE_XML )
+  if ( zypper.out().typeNORMAL() )
     cout << CLEARLN << _("Trying again...") << endl;
 
   return default_action;
@@ -0,0 +1,87 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file tests/HttpRepo_test.cc
+ *
+ * Refreshes the tests/data repos from a loopback \ref HttpServer, with
+ * shaped bandwidth, broken mirrors and mirror lists.
+ */
+
+#include "TestSetup.h"
+#include "HttpServer.h"
+
+using namespace std;
+using namespace zypp;
+
+static TestSetup test( Arch_x86_64 );
+
+static RepoInfo httpRepo( const std::string & alias_r )
+{
+  RepoInfo repo;
+  repo.setAlias( alias_r );
+  repo.setGpgCheck( false );
+  return repo;
+}
+
+BOOST_AUTO_TEST_CASE(http_refresh)
+{
+  HttpServer server;
+  server.setLatency( std::chrono::milliseconds( 20 ) );
+  server.setThroughput( 256 * 1024 );
+  server.start();
+
+  test.loadRepo( Url( server.url( "openSUSE-11.1_subset" ) ), "http_refresh" );
+
+  BOOST_CHECK( ! test.satpool().reposFind( "http_refresh" ).solvablesEmpty() );
+  BOOST_CHECK( server.bytesSent() > 0 );
+}
+
+BOOST_AUTO_TEST_CASE(http_mirror_fallback)
+{
+  HttpServer broken;
+  broken.failRequests( "/", 503 );
+  broken.start();
+
+  HttpServer mirror;
+  mirror.start();
+
+  RepoInfo repo( httpRepo( "http_mirror_fallback" ) );
+  repo.addBaseUrl( Url( broken.url( "openSUSE-11.1_subset" ) ) );
+  repo.addBaseUrl( Url( mirror.url( "openSUSE-11.1_subset" ) ) );
+  test.loadRepo( repo );
+
+  BOOST_CHECK( broken.failedRequests() > 0 );
+  BOOST_CHECK( mirror.requests() > 0 );
+  BOOST_CHECK( ! test.satpool().reposFind( "http_mirror_fallback" ).solvablesEmpty() );
+}
+
+BOOST_AUTO_TEST_CASE(http_mirror_list)
+{
+  HttpServer mirror;
+  mirror.start();
+
+  HttpServer server;
+  server.start();
+  server.setMirrorList( "mirrors/subset", { mirror.url( "openSUSE-11.1_subset" ) } );
+
+  RepoInfo repo( httpRepo( "http_mirror_list" ) );
+  repo.setMirrorListUrl( Url( server.url( "mirrors/subset" ) ) );
+  test.loadRepo( repo );
+
+  BOOST_CHECK( mirror.requests() > 0 );
+  BOOST_CHECK( ! test.satpool().reposFind( "http_mirror_list" ).solvablesEmpty() );
+}
+
+BOOST_AUTO_TEST_CASE(http_truncated_download)
+{
+  HttpServer server;
+  server.failRequests( "openSUSE-11.1_subset/repodata/primary.xml.gz", HttpServer::FAIL_TRUNCATE );
+  server.start();
+
+  BOOST_CHECK_THROW( test.loadRepo( Url( server.url( "openSUSE-11.1_subset" ) ), "http_truncated" ), Exception );
+  BOOST_CHECK( server.failedRequests() > 0 );
+}
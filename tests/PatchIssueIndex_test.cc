@@ -0,0 +1,51 @@
+#include "TestSetup.h"
+
+#include "PatchIssueIndex.h"
+
+using namespace std;
+using namespace zypp;
+
+static TestSetup test( Arch_x86_64 );
+
+BOOST_AUTO_TEST_CASE(setup)
+{
+  // patches with bugzilla and cve references
+  RepoInfo repo;
+  repo.setAlias( "upd" );
+  repo.addBaseUrl( Url( "file://" TESTS_SRC_DIR "/data/openSUSE-11.1_updates" ) );
+  repo.setGpgCheck( false );
+  test.loadRepo( repo );
+}
+
+static unsigned matches( const PatchIssueIndex & index_r, const Issue & issue_r, bool exact_r, bool matchTypes_r )
+{
+  unsigned ret = 0;
+  index_r.forEachMatch( issue_r, exact_r, matchTypes_r, [&ret]( const PatchIssueIndex::Ref & ) { ++ret; } );
+  return ret;
+}
+
+BOOST_AUTO_TEST_CASE(match_ids)
+{
+  PatchIssueIndex index( PatchIssueIndex::Filter() );
+
+  BOOST_CHECK_EQUAL( matches( index, Issue( "", "458579" ), true, false ), 1 );
+  BOOST_CHECK_EQUAL( matches( index, Issue( "bugzilla", "458579" ), true, false ), 1 );
+  BOOST_CHECK_EQUAL( matches( index, Issue( "cve", "458579" ), true, false ), 0 );
+  // a substring matches only if not exact
+  BOOST_CHECK_EQUAL( matches( index, Issue( "", "45857" ), true, false ), 0 );
+  BOOST_CHECK( matches( index, Issue( "", "45857" ), false, false ) >= 1 );
+}
+
+BOOST_AUTO_TEST_CASE(match_types)
+{
+  PatchIssueIndex index( PatchIssueIndex::Filter() );
+
+  // 'patch --issue-file': an id equal to a reference type matches nothing
+  BOOST_CHECK_EQUAL( matches( index, Issue( "", "bugzilla", true ), true, false ), 0 );
+  BOOST_CHECK_EQUAL( matches( index, Issue( "", "CVE", true ), true, false ), 0 );
+
+  // 'list-patches --issues=bugzilla' lists all of them (bnc#941309)
+  BOOST_CHECK( matches( index, Issue( "", "bugzilla" ), true, true ) > 100 );
+  BOOST_CHECK_EQUAL( matches( index, Issue( "", "bugzilla" ), true, true ),
+                     matches( index, Issue( "bugzilla", "" ), true, false ) );
+}
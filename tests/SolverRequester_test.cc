@@ -658,6 +658,28 @@ BOOST_AUTO_TEST_CASE(install403)
 ///////////////////////////////////////////////////////////////////////////
 
 
+// request : install vim nonsense1 ... nonsense7
+// response: enough arguments to use the batched name lookup;
+//           vim set to install, the others not found (same as unbatched)
+BOOST_AUTO_TEST_CASE(install500)
+{
+  MIL << "<============install500===============>" << endl;
+
+  vector<string> rawargs;
+  rawargs.push_back("vim");
+  for ( unsigned i = 1; i < 8; ++i )
+    rawargs.push_back(str::form("nonsense%u", i));
+  SolverRequester sr;
+
+  sr.install(rawargs);
+
+  BOOST_CHECK(sr.hasFeedback(SolverRequester::Feedback::SET_TO_INSTALL));
+  BOOST_CHECK(sr.hasFeedback(SolverRequester::Feedback::NOT_FOUND_NAME_TRYING_CAPS));
+  BOOST_CHECK(sr.hasFeedback(SolverRequester::Feedback::NOT_FOUND_CAP));
+  BOOST_CHECK_EQUAL(sr.toInstall().size(), 1);
+  BOOST_CHECK(hasPoolItem(sr.toInstall(), "vim", Edition("7.2-7.4.1"), Arch_x86_64));
+}
+
 ///////////////////////////////////////////////////////////////////////////
 // remove
 ///////////////////////////////////////////////////////////////////////////
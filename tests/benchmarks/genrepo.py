@@ -0,0 +1,268 @@
+#!/usr/bin/env python3
+
+# Generates synthetic rpm-md repositories for the zypper benchmarks.
+#
+# Writes a 'base' repo with the requested number of packages and an
+# 'update' repo with newer versions of some of them and patches in
+# updateinfo.xml. Packages have requires/provides between each other,
+# file lists and searchable summaries and descriptions. Output is
+# deterministic for a given --seed.
+#
+# With --installed-ratio, rpmbuild also builds minimal (empty) rpms of
+# the first packages of the base repo at version 1.0 into seed/, to be
+# installed into a test root so there is something to update. The first
+# n packages only require each other, so any such subset is consistent.
+#
+# See --help for the options.
+
+import argparse, gzip, hashlib, os, random, shutil, subprocess, sys, tempfile, time
+
+WORDS = ('library', 'tool', 'daemon', 'network', 'graphics', 'audio', 'video',
+         'parser', 'compiler', 'debugger', 'editor', 'terminal', 'kernel',
+         'module', 'plugin', 'theme', 'font', 'locale', 'python', 'perl',
+         'ruby', 'java', 'server', 'client', 'protocol', 'database', 'cache',
+         'archive', 'compression', 'crypto', 'security', 'desktop', 'manager',
+         'utility', 'development', 'documentation', 'example', 'runtime')
+
+CATEGORIES = ('security', 'recommended', 'optional', 'feature')
+SEVERITIES = ('critical', 'important', 'moderate', 'low')
+NS = 'http://linux.duke.edu/metadata/common'
+
+def esc(s):
+  return s.replace('&', '&amp;').replace('<', '&lt;').replace('>', '&gt;').replace('"', '&quot;')
+
+def pkgname(i):
+  return 'bench-%d' % i
+
+class Package:
+  def __init__(self, rnd, i):
+    self.i = i
+    self.name = pkgname(i)
+    self.words = rnd.sample(WORDS, 3)
+    self.summary = 'Synthetic %s %s for benchmarks' % (self.words[0], self.words[1])
+    self.description = ' '.join(rnd.choice(WORDS) for _ in range(40))
+    # depend on a few packages with lower numbers, so there are no cycles
+    self.requires = []
+    if i > 0:
+      for dep in sorted(set(rnd.randrange(i) for _ in range(rnd.randrange(6)))):
+        self.requires.append((pkgname(dep), rnd.random() < 0.3))
+      if rnd.random() < 0.2:
+        self.requires.append(('bench-cap(%d)' % rnd.randrange(min(i, 500) or 1), False))
+    self.files = ['/usr/bin/%s' % self.name] if rnd.random() < 0.4 else []
+    self.files += ['/usr/lib64/%s/%s-%d.so' % (self.name, rnd.choice(WORDS), n) for n in range(rnd.randrange(1, 6))]
+    self.files += ['/usr/share/doc/packages/%s/README' % self.name,
+                   '/usr/share/doc/packages/%s/COPYING' % self.name]
+    self.size = rnd.randrange(10000, 5000000)
+
+  def pkgid(self, version):
+    return hashlib.sha256(('%s-%s' % (self.name, version)).encode()).hexdigest()
+
+def primary_entry(out, pkg, version, buildtime):
+  ver, rel = version.split('-')
+  out.write('<package type="rpm">\n'
+            ' <name>%s</name>\n'
+            ' <arch>x86_64</arch>\n'
+            ' <version epoch="0" ver="%s" rel="%s"/>\n'
+            ' <checksum type="sha256" pkgid="YES">%s</checksum>\n'
+            ' <summary>%s</summary>\n'
+            ' <description>%s</description>\n'
+            ' <packager>Benchmarks</packager>\n'
+            ' <url>http://example.com/%s</url>\n'
+            ' <time file="%d" build="%d"/>\n'
+            ' <size package="%d" installed="%d" archive="%d"/>\n'
+            ' <location href="x86_64/%s-%s.x86_64.rpm"/>\n'
+            ' <format>\n'
+            '  <rpm:license>MIT</rpm:license>\n'
+            '  <rpm:vendor>Benchmarks</rpm:vendor>\n'
+            '  <rpm:group>Development/Benchmarks</rpm:group>\n'
+            '  <rpm:provides>\n'
+            '   <rpm:entry name="%s" flags="EQ" epoch="0" ver="%s" rel="%s"/>\n'
+            '   <rpm:entry name="bench-cap(%d)"/>\n'
+            '  </rpm:provides>\n'
+            % (pkg.name, ver, rel, pkg.pkgid(version), esc(pkg.summary), esc(pkg.description),
+               pkg.name, buildtime, buildtime, pkg.size, pkg.size * 3, pkg.size * 3,
+               pkg.name, version, pkg.name, ver, rel, pkg.i % 500))
+  if pkg.requires:
+    out.write('  <rpm:requires>\n')
+    for name, versioned in pkg.requires:
+      if versioned:
+        out.write('   <rpm:entry name="%s" flags="GE" epoch="0" ver="1.0"/>\n' % name)
+      else:
+        out.write('   <rpm:entry name="%s"/>\n' % name)
+    out.write('  </rpm:requires>\n')
+  # like createrepo: files in bin dirs go to primary, too
+  for f in pkg.files:
+    if f.startswith('/usr/bin/'):
+      out.write('  <file>%s</file>\n' % f)
+  out.write(' </format>\n</package>\n')
+
+def filelists_entry(out, pkg, version):
+  ver, rel = version.split('-')
+  out.write('<package pkgid="%s" name="%s" arch="x86_64">\n'
+            ' <version epoch="0" ver="%s" rel="%s"/>\n' % (pkg.pkgid(version), pkg.name, ver, rel))
+  for f in pkg.files:
+    out.write(' <file>%s</file>\n' % f)
+  out.write('</package>\n')
+
+def write_gz(path, write_fn):
+  with gzip.GzipFile(path, 'wb', mtime=0) as raw:
+    class Out:
+      def write(self, s):
+        raw.write(s.encode('utf-8'))
+    write_fn(Out())
+
+def sha256(path):
+  h = hashlib.sha256()
+  with open(path, 'rb') as f:
+    for block in iter(lambda: f.read(1 << 20), b''):
+      h.update(block)
+  return h.hexdigest()
+
+def open_sha256(path):
+  h = hashlib.sha256()
+  with gzip.open(path, 'rb') as f:
+    for block in iter(lambda: f.read(1 << 20), b''):
+      h.update(block)
+  return h.hexdigest()
+
+def write_repomd(repodir, files, timestamp):
+  with open(os.path.join(repodir, 'repodata', 'repomd.xml'), 'w') as out:
+    out.write('<?xml version="1.0" encoding="UTF-8"?>\n'
+              '<repomd xmlns="http://linux.duke.edu/metadata/repo" xmlns:rpm="http://linux.duke.edu/metadata/rpm">\n'
+              ' <revision>%d</revision>\n' % timestamp)
+    for mdtype, fname in files:
+      path = os.path.join(repodir, 'repodata', fname)
+      out.write(' <data type="%s">\n'
+                '  <checksum type="sha256">%s</checksum>\n'
+                '  <open-checksum type="sha256">%s</open-checksum>\n'
+                '  <location href="repodata/%s"/>\n'
+                '  <timestamp>%d</timestamp>\n'
+                '  <size>%d</size>\n'
+                ' </data>\n'
+                % (mdtype, sha256(path), open_sha256(path), fname, timestamp, os.path.getsize(path)))
+    out.write('</repomd>\n')
+
+def write_repo(repodir, entries, timestamp, patches=None):
+  """entries: list of (Package, version)"""
+  os.makedirs(os.path.join(repodir, 'repodata'), exist_ok=True)
+
+  def primary(out):
+    out.write('<?xml version="1.0" encoding="UTF-8"?>\n'
+              '<metadata xmlns="%s" xmlns:rpm="http://linux.duke.edu/metadata/rpm" packages="%d">\n'
+              % (NS, len(entries)))
+    for pkg, version in entries:
+      primary_entry(out, pkg, version, timestamp)
+    out.write('</metadata>\n')
+
+  def filelists(out):
+    out.write('<?xml version="1.0" encoding="UTF-8"?>\n'
+              '<filelists xmlns="http://linux.duke.edu/metadata/filelists" packages="%d">\n' % len(entries))
+    for pkg, version in entries:
+      filelists_entry(out, pkg, version)
+    out.write('</filelists>\n')
+
+  files = [('primary', 'primary.xml.gz'), ('filelists', 'filelists.xml.gz')]
+  write_gz(os.path.join(repodir, 'repodata', 'primary.xml.gz'), primary)
+  write_gz(os.path.join(repodir, 'repodata', 'filelists.xml.gz'), filelists)
+
+  if patches is not None:
+    def updateinfo(out):
+      out.write('<?xml version="1.0" encoding="UTF-8"?>\n<updates>\n')
+      for n, (category, severity, pkgs) in enumerate(patches):
+        out.write('<update from="benchmarks@example.com" status="stable" type="%s" version="1">\n'
+                  ' <id>bench-patch-%d</id>\n'
+                  ' <title>Update for %s</title>\n'
+                  ' <severity>%s</severity>\n'
+                  ' <release>Benchmarks</release>\n'
+                  ' <issued date="%d"/>\n'
+                  ' <description>Synthetic %s update of %d packages.</description>\n'
+                  ' <pkglist>\n  <collection>\n'
+                  % (category, n, esc(', '.join(p.name for p in pkgs)), severity, timestamp, category, len(pkgs)))
+        for p in pkgs:
+          out.write('   <package name="%s" arch="x86_64" version="1.1" release="1">\n'
+                    '    <filename>%s-1.1-1.x86_64.rpm</filename>\n'
+                    '   </package>\n' % (p.name, p.name))
+        out.write('  </collection>\n </pkglist>\n</update>\n')
+      out.write('</updates>\n')
+    write_gz(os.path.join(repodir, 'repodata', 'updateinfo.xml.gz'), updateinfo)
+    files.append(('updateinfo', 'updateinfo.xml.gz'))
+
+  write_repomd(repodir, files, timestamp)
+
+def spec_entry(out, pkg):
+  out.write('\n%%package -n %s\n'
+            'Summary: %s\n'
+            'Provides: bench-cap(%d)\n'
+            % (pkg.name, pkg.summary, pkg.i % 500))
+  for name, versioned in pkg.requires:
+    out.write('Requires: %s%s\n' % (name, ' >= 1.0' if versioned else ''))
+  out.write('\n%%description -n %s\n%s\n\n%%files -n %s\n' % (pkg.name, pkg.description, pkg.name))
+
+def build_seed(seeddir, pkgs):
+  """Build empty x86_64 rpms of pkgs into seeddir using rpmbuild (the subpackages inherit version 1.0-1)."""
+  rpmbuild = shutil.which('rpmbuild')
+  if not rpmbuild:
+    raise RuntimeError('rpmbuild is needed to build the installed packages (try installing rpm-build)')
+  topdir = tempfile.mkdtemp(prefix='genrepo-rpmbuild-')
+  try:
+    spec = os.path.join(topdir, 'bench-seed.spec')
+    with open(spec, 'w') as out:
+      # The main package has no %files, so only the subpackages are built.
+      out.write('Name: bench-seed\n'
+                'Version: 1.0\n'
+                'Release: 1\n'
+                'Summary: Installed packages for the zypper benchmarks\n'
+                'License: MIT\n'
+                'Group: Development/Benchmarks\n'
+                'Vendor: Benchmarks\n'
+                '\n%description\nInstalled packages for the zypper benchmarks.\n')
+      for pkg in pkgs:
+        spec_entry(out, pkg)
+    os.makedirs(seeddir, exist_ok=True)
+    subprocess.check_call([rpmbuild, '-bb', '--quiet', '--target', 'x86_64',
+                           '--define', '_topdir %s' % topdir,
+                           '--define', '_rpmdir %s' % seeddir,
+                           '--define', '_build_name_fmt %{NAME}-%{VERSION}-%{RELEASE}.%{ARCH}.rpm',
+                           '--define', '_binary_payload w0.ufdio',
+                           '--define', 'debug_package %{nil}',
+                           '--define', '__os_install_post %{nil}',
+                           spec], stdout=subprocess.DEVNULL)
+  finally:
+    shutil.rmtree(topdir, ignore_errors=True)
+
+def generate(outdir, npkgs, update_ratio, seed, installed_ratio=0):
+  rnd = random.Random(seed)
+  timestamp = 1500000000	# fixed, so the output is reproducible
+  pkgs = [Package(rnd, i) for i in range(npkgs)]
+  write_repo(os.path.join(outdir, 'base'), [(p, '1.0-1') for p in pkgs], timestamp)
+
+  updated = [p for p in pkgs if rnd.random() < update_ratio]
+  patches = []
+  pos = 0
+  while pos < len(updated):
+    n = rnd.randrange(1, 6)
+    patches.append((rnd.choice(CATEGORIES), rnd.choice(SEVERITIES), updated[pos:pos + n]))
+    pos += n
+  write_repo(os.path.join(outdir, 'update'), [(p, '1.1-1') for p in updated], timestamp + 86400, patches)
+
+  installed = pkgs[:int(npkgs * installed_ratio)]
+  if installed:
+    build_seed(os.path.join(outdir, 'seed'), installed)
+  return len(pkgs), len(updated), len(patches), len(installed)
+
+def main():
+  parser = argparse.ArgumentParser(description='Generate synthetic rpm-md repos (base and update) for the zypper benchmarks.')
+  parser.add_argument('outdir', help='directory to create the base/ and update/ repos in')
+  parser.add_argument('-n', '--packages', type=int, default=10000, help='number of packages in the base repo (default: %(default)s)')
+  parser.add_argument('-u', '--update-ratio', type=float, default=0.1, help='fraction of packages updated in the update repo (default: %(default)s)')
+  parser.add_argument('-s', '--seed', type=int, default=1, help='random seed (default: %(default)s)')
+  parser.add_argument('-i', '--installed-ratio', type=float, default=0, help='fraction of the base packages to build as rpms in seed/ (default: %(default)s)')
+  args = parser.parse_args()
+
+  start = time.time()
+  npkgs, nupdated, npatches, ninstalled = generate(args.outdir, args.packages, args.update_ratio, args.seed, args.installed_ratio)
+  sys.stderr.write('Generated %d packages, %d updates in %d patches, %d installable rpms below %s in %.1fs\n'
+                   % (npkgs, nupdated, npatches, ninstalled, args.outdir, time.time() - start))
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+
+# Times zypper commands against generated repos (see genrepo.py).
+#
+# A temporary root gets a 'base' and an 'update' repo of the requested
+# size. Each benchmarked command is run --runs times in it, and the
+# wall, user and system time and peak RSS are reported as JSON.
+# Given a --baseline (an earlier JSON result), commands whose median
+# wall time grew by more than --threshold are reported as regressions.
+#
+# The first --installed-ratio of the base packages are built as empty
+# rpms (genrepo.py, needs rpmbuild) and entered into the root's rpm
+# database with 'rpm --justdb', so 'lu', 'lp' and 'dup' render real
+# update lists and summaries. The 'install --dry-run' of a large name
+# glob covers the summary of a big transaction.
+#
+# See --help for the options.
+
+import argparse, json, os, shutil, subprocess, sys, tempfile, time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import genrepo
+
+def benchmarks(npkgs):
+  """(name, zypper arguments after the global ones)"""
+  some = genrepo.pkgname(npkgs // 2)
+  return [
+    ('refresh',			['refresh', '--force']),
+    ('search-name',		['search', 'bench-1']),
+    ('search-exact',		['search', '--match-exact', some]),
+    ('search-details',		['search', '--details', 'bench-12']),
+    ('search-description',	['search', '--search-descriptions', 'compiler']),
+    ('search-file',		['search', '--file-list', '/usr/bin/bench-7']),
+    ('search-xml',		['--xmlout', 'search', 'bench-1']),
+    ('search-json',		['--jsonout', 'search', 'bench-1']),
+    ('info',			['info', some]),
+    ('list-updates',		['list-updates']),
+    ('list-patches',		['list-patches', '--all']),
+    ('install-dry-run',		['install', '--dry-run', 'bench-1*']),
+    ('dist-upgrade-dry-run',	['dist-upgrade', '--dry-run']),
+  ]
+
+def run(cmd, env):
+  """Run cmd with output discarded; return (exit code, wall, user, sys, maxrss in kB)."""
+  start = time.monotonic()
+  proc = subprocess.Popen(cmd, env=env, stdin=subprocess.DEVNULL, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+  _, status, usage = os.wait4(proc.pid, 0)
+  wall = time.monotonic() - start
+  proc.returncode = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -os.WTERMSIG(status)
+  return proc.returncode, wall, usage.ru_utime, usage.ru_stime, usage.ru_maxrss
+
+def stats(values):
+  values = sorted(values)
+  return { 'min': round(values[0], 4), 'median': round(values[len(values) // 2], 4), 'max': round(values[-1], 4) }
+
+def install_seed(root, seeddir, env):
+  """Enter the seed rpms into the rpm database of root (nothing is unpacked)."""
+  rpm = shutil.which('rpm') or 'rpm'
+  subprocess.check_call([rpm, '--root', root, '--initdb'], env=env)
+  rpms = sorted(os.path.join(seeddir, f) for f in os.listdir(seeddir) if f.endswith('.rpm'))
+  for pos in range(0, len(rpms), 500):
+    subprocess.check_call([rpm, '--root', root, '--justdb', '--nodeps', '--noscripts', '--notriggers', '-i']
+                          + rpms[pos:pos + 500], env=env, stdout=subprocess.DEVNULL)
+  return len(rpms)
+
+def setup(zypper, workdir, args, env):
+  repodir = os.path.join(workdir, 'repos-%d-%g-%g-%d' % (args.packages, args.update_ratio, args.installed_ratio, args.seed))
+  if not os.path.isdir(repodir):
+    try:
+      genrepo.generate(repodir, args.packages, args.update_ratio, args.seed, args.installed_ratio)
+    except:
+      shutil.rmtree(repodir, ignore_errors=True)	# don't reuse it without the seed
+      raise
+
+  root = os.path.join(workdir, 'root')
+  shutil.rmtree(root, ignore_errors=True)
+  os.makedirs(root)
+  seeddir = os.path.join(repodir, 'seed')
+  if os.path.isdir(seeddir):
+    sys.stderr.write('Installed %d packages into %s\n' % (install_seed(root, seeddir, env), root))
+  for alias in ('base', 'update'):
+    subprocess.check_call([zypper, '--root', root, '--non-interactive', 'addrepo', '--no-gpgcheck',
+                           'dir://' + os.path.join(repodir, alias), alias],
+                          env=env, stdout=subprocess.DEVNULL)
+  subprocess.check_call([zypper, '--root', root, '--non-interactive', 'refresh'], env=env, stdout=subprocess.DEVNULL)
+  return root
+
+def compare(results, baseline, threshold):
+  """Print regressions against baseline; return their number."""
+  old = dict((r['name'], r) for r in baseline.get('results', []))
+  regressions = 0
+  for r in results:
+    if r['name'] not in old:
+      continue
+    before = old[r['name']]['wall']['median']
+    after = r['wall']['median']
+    if before > 0 and after > before * (1 + threshold):
+      regressions += 1
+      sys.stderr.write('REGRESSION %-22s %8.3fs -> %8.3fs (%+.0f%%)\n' % (r['name'], before, after, (after / before - 1) * 100))
+  return regressions
+
+def main():
+  parser = argparse.ArgumentParser(description='Time zypper commands against generated repos.')
+  parser.add_argument('--zypper', default='zypper', help='zypper binary to benchmark (default: %(default)s)')
+  parser.add_argument('-n', '--packages', type=int, default=10000, help='number of packages in the base repo (default: %(default)s)')
+  parser.add_argument('-u', '--update-ratio', type=float, default=0.1, help='fraction of packages updated (default: %(default)s)')
+  parser.add_argument('-i', '--installed-ratio', type=float, default=0.3, help='fraction of the base packages installed in the root (default: %(default)s)')
+  parser.add_argument('-s', '--seed', type=int, default=1, help='random seed of the generated repos (default: %(default)s)')
+  parser.add_argument('-r', '--runs', type=int, default=3, help='runs per command (default: %(default)s)')
+  parser.add_argument('-w', '--workdir', help='keep generated repos and the root here (default: a temporary directory)')
+  parser.add_argument('-o', '--output', help='write the JSON results here (default: stdout)')
+  parser.add_argument('-b', '--baseline', help='JSON results of an earlier run to compare with')
+  parser.add_argument('-t', '--threshold', type=float, default=0.2, help='relative slowdown reported as regression (default: %(default)s)')
+  parser.add_argument('--only', action='append', help='run only this benchmark (may be repeated)')
+  args = parser.parse_args()
+
+  zypper = shutil.which(args.zypper) or args.zypper
+  workdir = args.workdir or tempfile.mkdtemp(prefix='zypper-benchmarks-')
+  os.makedirs(workdir, exist_ok=True)
+
+  env = dict(os.environ)
+  env['LC_ALL'] = 'C'
+  env['ZYPP_LOGFILE'] = os.path.join(workdir, 'zypper.log')
+
+  try:
+    root = setup(zypper, workdir, args, env)
+
+    results = []
+    failed = 0
+    for name, cmdargs in benchmarks(args.packages):
+      if args.only and name not in args.only:
+        continue
+      cmd = [zypper, '--root', root, '--non-interactive'] + cmdargs
+      samples = [run(cmd, env) for _ in range(args.runs)]
+      exitcode = samples[-1][0]
+      # 100+ are informational (updates needed, ...)
+      if 0 < exitcode < 100:
+        failed += 1
+      result = { 'name': name,
+                 'command': ' '.join(['zypper'] + cmdargs),
+                 'exit': exitcode,
+                 'wall': stats([s[1] for s in samples]),
+                 'user': stats([s[2] for s in samples]),
+                 'sys': stats([s[3] for s in samples]),
+                 'maxrss_kb': max(s[4] for s in samples) }
+      results.append(result)
+      sys.stderr.write('%-22s %8.3fs  (exit %d)\n' % (name, result['wall']['median'], exitcode))
+
+    report = { 'format': 1,
+               'zypper': zypper,
+               'packages': args.packages,
+               'update_ratio': args.update_ratio,
+               'installed_ratio': args.installed_ratio,
+               'seed': args.seed,
+               'runs': args.runs,
+               'results': results }
+    text = json.dumps(report, indent=1, sort_keys=True) + '\n'
+    if args.output:
+      with open(args.output, 'w') as out:
+        out.write(text)
+    else:
+      sys.stdout.write(text)
+
+    regressions = 0
+    if args.baseline:
+      with open(args.baseline) as f:
+        regressions = compare(results, json.load(f), args.threshold)
+
+    if failed:
+      sys.stderr.write('%d benchmarked commands failed, see %s\n' % (failed, env['ZYPP_LOGFILE']))
+    return 2 if failed else 1 if regressions else 0
+  finally:
+    if not args.workdir:
+      shutil.rmtree(workdir, ignore_errors=True)
+
+if __name__ == '__main__':
+  sys.exit(main())
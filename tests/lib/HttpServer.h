@@ -0,0 +1,414 @@
+#ifndef INCLUDE_HTTPSERVER
+#define INCLUDE_HTTPSERVER
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** Loopback HTTP server for tests, serving the files below a document
+ * root (by default the repos in \c tests/data) on \c 127.0.0.1.
+ *
+ * Refresh and download code can be tested and timed offline this way,
+ * with reproducible network conditions:
+ * \li \ref setLatency delays each response,
+ * \li \ref setThroughput limits the bytes per second of each connection,
+ * \li \ref failRequests answers requests below some path with an error
+ *     status, drops or truncates them (always, or for the next N requests),
+ * \li \ref setMirrorList serves a mirror list (plain text, one URL per
+ *     line) at some path, e.g. pointing to other \c HttpServer instances.
+ *
+ * Every connection is served by a thread of its own, so parallel
+ * downloads see independent bandwidth. Responses are \c HTTP/1.1 with
+ * \c Connection: close; \c GET and \c HEAD are supported.
+ *
+ * \code
+ * #include "TestSetup.h"
+ * #include "HttpServer.h"
+ *
+ * BOOST_AUTO_TEST_CASE(refresh_slow_mirror)
+ * {
+ *   HttpServer server;
+ *   server.setLatency( std::chrono::milliseconds( 50 ) );
+ *   server.setThroughput( 256 * 1024 );
+ *   server.start();
+ *
+ *   TestSetup test( Arch_x86_64 );
+ *   test.loadRepo( Url( server.url( "openSUSE-11.1_subset" ) ) );
+ * }
+ * \endcode
+ */
+class HttpServer
+{
+  public:
+    /** What a failing request gets (see \ref failRequests). */
+    enum FailMode
+    {
+      FAIL_STATUS,	//< respond with the given HTTP status
+      FAIL_DROP,	//< close the connection without a response
+      FAIL_TRUNCATE	//< send the headers and half of the body, then close
+    };
+
+  public:
+    explicit HttpServer( const std::string & docroot_r = TESTS_SRC_DIR"/data" )
+    : _docroot( docroot_r )
+    , _listenfd( -1 )
+    , _port( 0 )
+    , _running( false )
+    , _latency( 0 )
+    , _throughput( 0 )
+    , _requests( 0 )
+    , _failed( 0 )
+    , _bytesSent( 0 )
+    {}
+
+    ~HttpServer()
+    { stop(); }
+
+    HttpServer( const HttpServer & ) = delete;
+    HttpServer & operator=( const HttpServer & ) = delete;
+
+  public:
+    /** Delay before each response is sent. */
+    void setLatency( std::chrono::milliseconds latency_r )
+    { std::lock_guard<std::mutex> lock( _mutex ); _latency = latency_r; }
+
+    /** Limit each connection to \a bytesPerSecond_r (\c 0: unlimited). */
+    void setThroughput( size_t bytesPerSecond_r )
+    { std::lock_guard<std::mutex> lock( _mutex ); _throughput = bytesPerSecond_r; }
+
+    /** Let requests for paths starting with \a prefix_r fail with \a status_r.
+     * Only the next \a count_r matching requests fail, or all if \c 0.
+     * Rules are checked in the order they were added.
+     */
+    void failRequests( const std::string & prefix_r, int status_r = 500, unsigned count_r = 0 )
+    { addRule( prefix_r, FAIL_STATUS, status_r, count_r ); }
+
+    /** \overload Let them fail as \a mode_r says. */
+    void failRequests( const std::string & prefix_r, FailMode mode_r, unsigned count_r = 0 )
+    { addRule( prefix_r, mode_r, 500, count_r ); }
+
+    /** Remove all \ref failRequests rules. */
+    void clearFailures()
+    { std::lock_guard<std::mutex> lock( _mutex ); _rules.clear(); }
+
+    /** Serve a mirror list (one URL per line) listing \a urls_r at \a path_r.
+     * \note The \ref url of a server is known after it was \ref start ed.
+     */
+    void setMirrorList( const std::string & path_r, const std::vector<std::string> & urls_r )
+    {
+      std::string body( "# mirror list\n" );
+      for ( const std::string & url : urls_r )
+        body += url + "\n";
+      std::lock_guard<std::mutex> lock( _mutex );
+      _mirrorLists.push_back( std::make_pair( normalize( path_r ), body ) );
+    }
+
+  public:
+    /** Listen on a free loopback port and start serving. */
+    void start()
+    {
+      if ( _running )
+        return;
+
+      _listenfd = ::socket( AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+      if ( _listenfd < 0 )
+        throw std::runtime_error( std::string( "socket: " ) + ::strerror( errno ) );
+
+      int on = 1;
+      ::setsockopt( _listenfd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on) );
+
+      struct sockaddr_in addr;
+      ::memset( &addr, 0, sizeof(addr) );
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+      addr.sin_port = 0;	// any free port
+      socklen_t len = sizeof(addr);
+      if ( ::bind( _listenfd, (struct sockaddr *)&addr, sizeof(addr) ) != 0
+        || ::listen( _listenfd, 64 ) != 0
+        || ::getsockname( _listenfd, (struct sockaddr *)&addr, &len ) != 0 )
+      {
+        std::string err( ::strerror( errno ) );
+        ::close( _listenfd );
+        _listenfd = -1;
+        throw std::runtime_error( "bind/listen: " + err );
+      }
+      _port = ntohs( addr.sin_port );
+
+      _running = true;
+      _acceptor = std::thread( &HttpServer::acceptLoop, this );
+    }
+
+    /** Stop serving and wait for the running connections to finish. */
+    void stop()
+    {
+      if ( ! _running )
+        return;
+      _running = false;
+      _acceptor.join();
+      ::close( _listenfd );
+      _listenfd = -1;
+
+      std::list<std::thread> workers;
+      {
+        std::lock_guard<std::mutex> lock( _mutex );
+        workers.swap( _workers );
+      }
+      for ( std::thread & worker : workers )
+        worker.join();
+    }
+
+  public:
+    unsigned short port() const
+    { return _port; }
+
+    /** URL of \a path_r (relative to the document root). */
+    std::string url( const std::string & path_r = std::string() ) const
+    {
+      std::ostringstream str;
+      str << "http://127.0.0.1:" << _port << normalize( path_r );
+      return str.str();
+    }
+
+    /** Number of requests received so far. */
+    unsigned requests() const
+    { return _requests; }
+
+    /** Number of requests failed by \ref failRequests so far. */
+    unsigned failedRequests() const
+    { return _failed; }
+
+    /** Number of body bytes sent so far. */
+    unsigned long long bytesSent() const
+    { return _bytesSent; }
+
+  private:
+    struct Rule
+    {
+      std::string prefix;
+      FailMode mode;
+      int status;
+      unsigned count;	//< requests left to fail; 0: all
+    };
+
+    void addRule( const std::string & prefix_r, FailMode mode_r, int status_r, unsigned count_r )
+    {
+      Rule rule = { normalize( prefix_r ), mode_r, status_r, count_r };
+      std::lock_guard<std::mutex> lock( _mutex );
+      _rules.push_back( rule );
+    }
+
+    /** \a path_r with a leading '/'. */
+    static std::string normalize( const std::string & path_r )
+    { return( path_r.empty() || path_r[0] != '/' ? "/" + path_r : path_r ); }
+
+    void acceptLoop()
+    {
+      while ( _running )
+      {
+        struct pollfd pfd = { _listenfd, POLLIN, 0 };
+        if ( ::poll( &pfd, 1, 100 ) <= 0 )
+          continue;	// timeout (check _running) or EINTR
+
+        int fd = ::accept4( _listenfd, nullptr, nullptr, SOCK_CLOEXEC );
+        if ( fd < 0 )
+          continue;
+
+        std::lock_guard<std::mutex> lock( _mutex );
+        _workers.push_back( std::thread( &HttpServer::serve, this, fd ) );
+      }
+    }
+
+    /** Read the request head; \c false if the client went away. */
+    static bool readRequest( int fd_r, std::string & method_r, std::string & path_r )
+    {
+      std::string head;
+      char buf[4096];
+      while ( head.find( "\r\n\r\n" ) == std::string::npos && head.size() < 65536 )
+      {
+        ssize_t got = ::recv( fd_r, buf, sizeof(buf), 0 );
+        if ( got <= 0 )
+          return false;
+        head.append( buf, got );
+      }
+      std::istringstream line( head.substr( 0, head.find( "\r\n" ) ) );
+      line >> method_r >> path_r;
+      path_r = normalize( path_r.substr( 0, path_r.find_first_of( "?#" ) ) );
+      return ! method_r.empty();
+    }
+
+    /** Send all of \a size_r bytes, shaped to \a throughput_r. */
+    bool sendAll( int fd_r, const char * data_r, size_t size_r, size_t throughput_r )
+    {
+      typedef std::chrono::steady_clock Clock;
+      Clock::time_point start( Clock::now() );
+      size_t chunk = throughput_r ? std::max<size_t>( throughput_r / 20, 1024 ) : size_r;	// ~20 writes per second
+      size_t sent = 0;
+      while ( sent < size_r )
+      {
+        ssize_t put = ::send( fd_r, data_r + sent, std::min( chunk, size_r - sent ), MSG_NOSIGNAL );
+        if ( put <= 0 )
+          return false;
+        sent += put;
+        if ( throughput_r )
+          std::this_thread::sleep_until( start + std::chrono::microseconds( sent * 1000000ULL / throughput_r ) );
+      }
+      return true;
+    }
+
+    void serve( int fd_r )
+    {
+      std::string method;
+      std::string path;
+      if ( ! readRequest( fd_r, method, path ) )
+      {
+        ::close( fd_r );
+        return;
+      }
+      ++_requests;
+
+      // snapshot of the settings, and the matching rule
+      std::chrono::milliseconds latency;
+      size_t throughput;
+      Rule fail = { std::string(), FAIL_STATUS, 0, 0 };
+      std::string body;
+      bool haveBody = false;
+      {
+        std::lock_guard<std::mutex> lock( _mutex );
+        latency = _latency;
+        throughput = _throughput;
+        for ( auto it = _rules.begin(); it != _rules.end(); ++it )
+        {
+          if ( path.compare( 0, it->prefix.size(), it->prefix ) != 0 )
+            continue;
+          fail = *it;
+          if ( it->count && --(it->count) == 0 )
+            _rules.erase( it );
+          break;
+        }
+        for ( const auto & list : _mirrorLists )
+        {
+          if ( list.first == path )
+          {
+            body = list.second;
+            haveBody = true;
+            break;
+          }
+        }
+      }
+
+      if ( latency.count() )
+        std::this_thread::sleep_for( latency );
+
+      int status = 200;
+      if ( fail.status || fail.mode != FAIL_STATUS )
+      {
+        ++_failed;
+        if ( fail.mode == FAIL_DROP )
+        {
+          ::close( fd_r );
+          return;
+        }
+        if ( fail.mode == FAIL_STATUS )
+          status = fail.status;
+      }
+
+      if ( method != "GET" && method != "HEAD" )
+        status = 405;
+
+      size_t length = body.size();
+      if ( status == 200 && ! haveBody )
+      {
+        std::string file( _docroot + path );
+        struct stat st;
+        if ( path.find( "/.." ) != std::string::npos || ::stat( file.c_str(), &st ) != 0 || ! S_ISREG( st.st_mode ) )
+          status = 404;
+        else
+        {
+          length = st.st_size;
+          if ( method != "HEAD" )
+          {
+            std::ifstream in( file.c_str(), std::ios::binary );
+            std::ostringstream content;
+            content << in.rdbuf();
+            body = content.str();
+          }
+        }
+      }
+      if ( status != 200 )
+      {
+        body = statusText( status ) + "\n";
+        length = body.size();
+      }
+
+      std::ostringstream head;
+      head << "HTTP/1.1 " << status << ' ' << statusText( status ) << "\r\n"
+           << "Content-Length: " << length << "\r\n"
+           << "Content-Type: " << ( haveBody || status != 200 ? "text/plain" : "application/octet-stream" ) << "\r\n"
+           << "Connection: close\r\n"
+           << "\r\n";
+      std::string headstr( head.str() );
+
+      if ( sendAll( fd_r, headstr.data(), headstr.size(), 0 ) && method != "HEAD" )
+      {
+        size_t size = ( fail.mode == FAIL_TRUNCATE ? body.size() / 2 : body.size() );
+        if ( sendAll( fd_r, body.data(), size, throughput ) )
+          _bytesSent += size;
+      }
+      ::shutdown( fd_r, SHUT_WR );
+      ::close( fd_r );
+    }
+
+    static std::string statusText( int status_r )
+    {
+      switch ( status_r )
+      {
+        case 200: return "OK";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 500: return "Internal Server Error";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+      }
+      return "Status";
+    }
+
+  private:
+    std::string _docroot;
+    int _listenfd;
+    unsigned short _port;
+    std::atomic<bool> _running;
+    std::thread _acceptor;
+
+    std::mutex _mutex;	//< guards the settings below and _workers
+    std::chrono::milliseconds _latency;
+    size_t _throughput;
+    std::list<Rule> _rules;
+    std::list<std::pair<std::string,std::string>> _mirrorLists;	//< path, body
+    std::list<std::thread> _workers;
+
+    std::atomic<unsigned> _requests;
+    std::atomic<unsigned> _failed;
+    std::atomic<unsigned long long> _bytesSent;
+};
+
+#endif //INCLUDE_HTTPSERVER
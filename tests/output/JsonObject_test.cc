@@ -0,0 +1,85 @@
+#include "TestSetup.h"
+
+#include <sstream>
+
+#include "output/JsonObject.h"
+
+using namespace std;
+
+// Expected strings as written by Python's json.dumps( ..., ensure_ascii=False ).
+
+BOOST_AUTO_TEST_CASE(quote_escaped_chars)
+{
+  struct { char ch; const char * json; } expected[] = {
+    { '\x00', "\"\\u0000\"" },
+    { '\x01', "\"\\u0001\"" },
+    { '\x02', "\"\\u0002\"" },
+    { '\x03', "\"\\u0003\"" },
+    { '\x04', "\"\\u0004\"" },
+    { '\x05', "\"\\u0005\"" },
+    { '\x06', "\"\\u0006\"" },
+    { '\x07', "\"\\u0007\"" },
+    { '\x08', "\"\\b\"" },
+    { '\x09', "\"\\t\"" },
+    { '\x0a', "\"\\n\"" },
+    { '\x0b', "\"\\u000b\"" },
+    { '\x0c', "\"\\f\"" },
+    { '\x0d', "\"\\r\"" },
+    { '\x0e', "\"\\u000e\"" },
+    { '\x0f', "\"\\u000f\"" },
+    { '\x10', "\"\\u0010\"" },
+    { '\x11', "\"\\u0011\"" },
+    { '\x12', "\"\\u0012\"" },
+    { '\x13', "\"\\u0013\"" },
+    { '\x14', "\"\\u0014\"" },
+    { '\x15', "\"\\u0015\"" },
+    { '\x16', "\"\\u0016\"" },
+    { '\x17', "\"\\u0017\"" },
+    { '\x18', "\"\\u0018\"" },
+    { '\x19', "\"\\u0019\"" },
+    { '\x1a', "\"\\u001a\"" },
+    { '\x1b', "\"\\u001b\"" },
+    { '\x1c', "\"\\u001c\"" },
+    { '\x1d', "\"\\u001d\"" },
+    { '\x1e', "\"\\u001e\"" },
+    { '\x1f', "\"\\u001f\"" },
+    { '"',    "\"\\\"\"" },
+    { '\\',   "\"\\\\\"" },
+  };
+  for ( unsigned i = 0; i < sizeof(expected)/sizeof(*expected); ++i )
+  {
+    string json;
+    JsonObject::quote( json, string( 1, expected[i].ch ) );
+    BOOST_CHECK_EQUAL( json, expected[i].json );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(quote_other_bytes_unchanged)
+{
+  // everything else, including DEL and UTF-8 sequences, is copied as it is
+  for ( unsigned ch = 0x20; ch < 0x100; ++ch )
+  {
+    if ( ch == '"' || ch == '\\' )
+      continue;
+    string text( 1, char(ch) );
+    string json;
+    JsonObject::quote( json, text );
+    BOOST_CHECK_EQUAL( json, "\"" + text + "\"" );
+  }
+
+  string json;
+  JsonObject::quote( json, "Koľko \"stĺpcov\"\n\tC:\\" );
+  BOOST_CHECK_EQUAL( json, "\"Koľko \\\"stĺpcov\\\"\\n\\tC:\\\\\"" );
+}
+
+BOOST_AUTO_TEST_CASE(object_members)
+{
+  BOOST_CHECK_EQUAL( JsonObject().asString(), "{}" );
+  BOOST_CHECK_EQUAL( JsonObject().add( "type", "message" ).add( "n", 42 ).add( "neg", -7L )
+                     .add( "ok", true ).addRaw( "list", "[1,2]" ).asString(),
+                     "{\"type\":\"message\",\"n\":42,\"neg\":-7,\"ok\":true,\"list\":[1,2]}" );
+
+  ostringstream out;
+  JsonObject().add( "a\"b", string( "x" ) ).writeLine( out );
+  BOOST_CHECK_EQUAL( out.str(), "{\"a\\\"b\":\"x\"}\n" );
+}
@@ -0,0 +1,81 @@
+#include "TestSetup.h"
+
+#include <sstream>
+
+#include <zypp/parser/xml/XmlEscape.h>
+
+#include "output/XmlWriter.h"
+
+using namespace std;
+
+// escapeTo() scans 8 byte words, so try every length up to two words plus
+// one, with special chars at every offset, between fillers that are close
+// to them or stress the word scan (NUL, high bit set).
+
+static const char specials[] = { '<', '>', '&', '"', '\'' };
+static const char fillers[] = { 'a', ';', '=', '?', '\0', '\x80', '\xff' };
+
+static void checkEscape( const string & text_r )
+{
+  BOOST_CHECK_EQUAL( XmlWriter::escape( text_r ), zypp::xml::escape( text_r ) );
+}
+
+BOOST_AUTO_TEST_CASE(escape_one_special)
+{
+  for ( char filler : fillers )
+  {
+    for ( unsigned len = 0; len <= 17; ++len )
+    {
+      checkEscape( string( len, filler ) );
+      for ( unsigned off = 0; off < len; ++off )
+      {
+	for ( char special : specials )
+	{
+	  string text( len, filler );
+	  text[off] = special;
+	  checkEscape( text );
+	}
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(escape_two_specials)
+{
+  for ( unsigned len = 2; len <= 17; ++len )
+    for ( unsigned off1 = 0; off1 < len; ++off1 )
+      for ( unsigned off2 = off1 + 1; off2 < len; ++off2 )
+	for ( char special1 : specials )
+	  for ( char special2 : specials )
+	  {
+	    string text( len, 'x' );
+	    text[off1] = special1;
+	    text[off2] = special2;
+	    checkEscape( text );
+	  }
+}
+
+BOOST_AUTO_TEST_CASE(escape_appends)
+{
+  string buf( "<a>" );
+  XmlWriter::escapeTo( buf, "1 < 2" );
+  BOOST_CHECK_EQUAL( buf, "<a>1 &lt; 2" );
+}
+
+BOOST_AUTO_TEST_CASE(writer_output)
+{
+  ostringstream expected;
+  ostringstream out;
+  {
+    XmlWriter xml( out, 16 );	// small blocks to write several of them
+    xml << "<solvable" << XmlWriter::Attr( "name", "a&b" ) << XmlWriter::Attr( "size", string( "42" ) ) << ">";
+    xml << XmlWriter::Text( "\"quoted\" <text>" ) << '\n';
+    xml << 42 << ' ' << -7 << ' ' << 123456789012LL << ' ' << (unsigned short)5 << ' ' << 0U;
+    xml << "</solvable>\n";
+  }
+  expected << "<solvable name=\"a&amp;b\" size=\"42\">";
+  expected << "&quot;quoted&quot; &lt;text&gt;" << '\n';
+  expected << 42 << ' ' << -7 << ' ' << 123456789012LL << ' ' << (unsigned short)5 << ' ' << 0U;
+  expected << "</solvable>\n";
+  BOOST_CHECK_EQUAL( out.str(), expected.str() );
+}
@@ -0,0 +1,96 @@
+#include "TestSetup.h"
+
+#include <fstream>
+
+#include <zypp/TmpPath.h>
+
+#include "utils/IniConfig.h"
+
+using namespace std;
+using zypp::filesystem::TmpFile;
+
+// The cases mirror what the former zypper.aug Augeas lens accepted and
+// rejected: a rejected file contributes no options at all.
+
+static bool parseString( const string & content_r, IniConfig::Options & options_r, string & error_r )
+{
+  TmpFile file;
+  {
+    ofstream out( file.path().c_str() );
+    out << content_r;
+  }
+  return IniConfig::parse( file.path(), options_r, error_r );
+}
+
+BOOST_AUTO_TEST_CASE(valid_file)
+{
+  IniConfig::Options options;
+  string error;
+  BOOST_CHECK( parseString(
+    "## leading description\n"
+    "\n"
+    "[main]\n"
+    "## Description of the option\n"
+    "# showAlias = false\n"
+    "showAlias = true\n"
+    "  repoListColumns =  anrp \n"
+    "\n"
+    "[color]\n"
+    "useColors=never\n"
+    "result.packageName = fg_bold\n", options, error ) );
+  BOOST_CHECK( error.empty() );
+  BOOST_CHECK_EQUAL( options.size(), 4 );
+  BOOST_CHECK_EQUAL( options["main/showAlias"], "true" );
+  BOOST_CHECK_EQUAL( options["main/repoListColumns"], "anrp" );
+  BOOST_CHECK_EQUAL( options["color/useColors"], "never" );
+  BOOST_CHECK_EQUAL( options["color/result.packageName"], "fg_bold" );
+}
+
+BOOST_AUTO_TEST_CASE(duplicate_keys)
+{
+  // Augeas reported multiple matches, so the option was treated as not
+  // set in this file; the rest of the file is still used.
+  IniConfig::Options options;
+  string error;
+  BOOST_CHECK( parseString( "[main]\nshowAlias = true\nrepoListColumns = anr\nshowAlias = false\nshowAlias = true\n", options, error ) );
+  BOOST_CHECK( error.empty() );
+  BOOST_CHECK_EQUAL( options.count( "main/showAlias" ), 0 );
+  BOOST_CHECK_EQUAL( options["main/repoListColumns"], "anr" );
+
+  // also if the section is opened again
+  options.clear();
+  BOOST_CHECK( parseString( "[main]\nshowAlias = true\n[color]\nuseColors = never\n[main]\nshowAlias = false\n", options, error ) );
+  BOOST_CHECK_EQUAL( options.count( "main/showAlias" ), 0 );
+  BOOST_CHECK_EQUAL( options["color/useColors"], "never" );
+
+  // the same key in different sections is fine
+  options.clear();
+  BOOST_CHECK( parseString( "[a]\nkey = 1\n[b]\nkey = 2\n", options, error ) );
+  BOOST_CHECK_EQUAL( options["a/key"], "1" );
+  BOOST_CHECK_EQUAL( options["b/key"], "2" );
+}
+
+BOOST_AUTO_TEST_CASE(syntax_errors)
+{
+  const char * bad[] = {
+    "key = value\n",			// option outside of a section
+    "[main\nkey = value\n",		// unterminated section header
+    "[]\nkey = value\n",		// empty section name
+    "[ma in]\nkey = value\n",		// whitespace in section name
+    "[main]\nkey value\n",		// no '='
+    "[main]\n= value\n",		// no key
+    "[main]\nkey =\n",			// no value
+    "[main]\n1key = value\n",		// key must start with a letter
+    "[main]\nkey. = value\n",		// key must end with a letter or digit
+    "[main]\nsome-key = value\n",	// invalid character in key
+    "[main]\ngood = 1\n[main\n",	// error after valid options
+  };
+  for ( unsigned i = 0; i < sizeof(bad)/sizeof(*bad); ++i )
+  {
+    IniConfig::Options options;
+    string error;
+    BOOST_CHECK_MESSAGE( ! parseString( bad[i], options, error ), "accepted: " << bad[i] );
+    BOOST_CHECK_MESSAGE( ! error.empty(), "no error for: " << bad[i] );
+    BOOST_CHECK( options.empty() );
+  }
+}
@@ -17,7 +17,6 @@
 
 
 Name:           @PACKAGE@
-BuildRequires:  augeas-devel >= 0.5.0
 BuildRequires:  boost-devel >= 1.33.1
 BuildRequires:  cmake >= 2.4.6
 BuildRequires:  gcc-c++ >= 4.7
@@ -155,7 +154,6 @@ rm -rf "$RPM_BUILD_ROOT"
 %{_bindir}/installation_sources
 %{_sbindir}/zypp-refresh
 %dir %{_datadir}/zypper
-%{_datadir}/zypper/zypper.aug
 %dir %{_datadir}/zypper/xml
 %{_datadir}/zypper/xml/xmlout.rnc
 %{_prefix}/lib/zypper